@@ -15,13 +15,30 @@
 
 #include<iostream>
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <new>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+#include <climits>
 #include <ctime>
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 class Cat {
 public:
-    string name;     // Имя кота
+    string_view name; // Имя кота (строка хранится в таблице имен зоопарка)
     int age;         // Возраст кота
     int fullness;    // Сытость (от 0 до 100)
     int tiredness;   // Усталость (от 0 до 100)
@@ -31,7 +48,7 @@ public:
      * @param name Имя кота
      * @param age Возраст кота
      */
-    Cat(string name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
+    Cat(string_view name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
 
     /**
      * @brief Метод, моделирующий течение времени и изменяющий усталость и сытость кота.
@@ -56,11 +73,19 @@ public:
     void eat() {
         fullness = 100;
     }
+
+    /**
+     * @brief Время отдыха в вольере, за которое усталость кота спадет до нуля.
+     * @return Количество часов (за час отдыха усталость уменьшается на 20)
+     */
+    int restDuration() const {
+        return (tiredness + 19) / 20;
+    }
 };
 
 class Dog {
 public:
-    string name;     
+    string_view name;
     int age;         
     int fullness;    
     int tiredness;   
@@ -70,7 +95,7 @@ public:
      * @param name Имя собаки
      * @param age Возраст собаки
      */
-    Dog(string name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
+    Dog(string_view name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
 
     /**
      * @brief Метод, моделирующий течение времени и изменяющий усталость и сытость собаки.
@@ -95,11 +120,19 @@ public:
     void eat() {
         fullness = 100;
     }
+
+    /**
+     * @brief Время отдыха в вольере, за которое усталость собаки спадет до нуля.
+     * @return Количество часов (за час отдыха усталость уменьшается на 40)
+     */
+    int restDuration() const {
+        return (tiredness + 39) / 40;
+    }
 };
 
 class Wombat {
 public:
-    string name;     
+    string_view name;
     int age;         
     int fullness;    
     int tiredness;   
@@ -109,7 +142,7 @@ public:
      * @param name Имя вомбата
      * @param age Возраст вомбата
      */
-    Wombat(string name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
+    Wombat(string_view name, int age) : name(name), age(age), fullness(100), tiredness(0) {}
 
     /**
      * @brief Метод, моделирующий течение времени и изменяющий усталость и сытость вомбата.
@@ -134,31 +167,335 @@ public:
     void eat() {
         fullness = 100;
     }
+
+    /**
+     * @brief Время отдыха в вольере, за которое усталость вомбата спадет до нуля.
+     * @return Количество часов (за час отдыха усталость уменьшается на 30)
+     */
+    int restDuration() const {
+        return (tiredness + 29) / 30;
+    }
 };
 
 class Animal {
 public:
-    void* animal;    // Указатель на конкретное животное (Cat, Dog, Wombat)
-    string type;     // Тип животного (Cat, Dog, Wombat)
+    void* animal;      // Указатель на конкретное животное (Cat, Dog, Wombat)
+    string_view type;  // Тип животного (Cat, Dog, Wombat)
 
     /**
      * @brief Конструктор для создания животного.
      * @param animal Указатель на объект животного
-     * @param type Тип животного (строка)
+     * @param type Тип животного (строковый литерал)
      */
-    Animal(void* animal, string type) : animal(animal), type(type) {}
+    Animal(void* animal, string_view type) : animal(animal), type(type) {}
+};
+
+/**
+ * @brief Пул объектов одного типа.
+ *
+ * Объекты размещаются подряд в крупных блоках, размер которых растет геометрически,
+ * поэтому N объектов требуют O(log N) выделений памяти (или одно после reserve).
+ * Все объекты уничтожаются вместе с пулом.
+ * @tparam T Тип объектов
+ */
+template <typename T>
+class Pool {
+public:
+    Pool() : nextCapacity(64) {}
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    ~Pool() {
+        for (Chunk& chunk : chunks) {
+            for (size_t i = 0; i < chunk.used; ++i) {
+                chunk.data[i].~T();
+            }
+            ::operator delete(chunk.data);
+        }
+    }
+
+    /**
+     * @brief Гарантирует место еще под n объектов без новых выделений памяти.
+     * @param n Количество объектов
+     */
+    void reserve(size_t n) {
+        if (n == 0) {
+            return;
+        }
+        if (chunks.empty() || chunks.back().capacity - chunks.back().used < n) {
+            addChunk(n);
+        }
+    }
+
+    /**
+     * @brief Создает объект в пуле.
+     * @param args Аргументы конструктора T
+     * @return Указатель на объект, действительный до уничтожения пула
+     */
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (chunks.empty() || chunks.back().used == chunks.back().capacity) {
+            addChunk(nextCapacity);
+        }
+        Chunk& chunk = chunks.back();
+        T* object = new (chunk.data + chunk.used) T(std::forward<Args>(args)...);
+        ++chunk.used;
+        return object;
+    }
+
+private:
+    struct Chunk {
+        T* data;
+        size_t used;
+        size_t capacity;
+    };
+
+    vector<Chunk> chunks;
+    size_t nextCapacity;
+
+    void addChunk(size_t capacity) {
+        T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+        chunks.push_back(Chunk{data, 0, capacity});
+        nextCapacity = 2 * (capacity > nextCapacity ? capacity : nextCapacity);
+    }
+};
+
+/**
+ * @brief Таблица имен животных.
+ *
+ * Строки хранятся подряд в крупных блоках символов, животные держат на них string_view.
+ * Одинаковые имена, введенные пользователем, хранятся один раз.
+ */
+class NameTable {
+public:
+    NameTable() : used(0), capacity(0) {}
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    ~NameTable() {
+        for (char* block : blocks) {
+            delete[] block;
+        }
+    }
+
+    /**
+     * @brief Возвращает единственную копию имени в таблице.
+     * @param name Имя
+     * @return Представление строки, действительное до уничтожения таблицы
+     */
+    string_view intern(string_view name) {
+        auto it = interned.find(name);
+        if (it != interned.end()) {
+            return *it;
+        }
+        string_view stored = store(name);
+        interned.insert(stored);
+        return stored;
+    }
+
+    /**
+     * @brief Создает сгенерированное имя вида "Cat_123".
+     *
+     * Такие имена уникальны по построению, поэтому они не ищутся в таблице повторов.
+     * @param prefix Префикс (тип животного)
+     * @param id Номер животного
+     */
+    string_view generate(string_view prefix, int id) {
+        char buffer[64];
+        size_t length = prefix.copy(buffer, 40);
+        buffer[length++] = '_';
+        char digits[16];
+        int count = 0;
+        do {
+            digits[count++] = '0' + id % 10;
+            id /= 10;
+        } while (id > 0);
+        while (count > 0) {
+            buffer[length++] = digits[--count];
+        }
+        return store(string_view(buffer, length));
+    }
+
+private:
+    static const size_t blockSize = 1 << 20;
+
+    vector<char*> blocks;
+    size_t used;
+    size_t capacity;
+    unordered_set<string_view> interned;
+
+    string_view store(string_view text) {
+        if (text.empty()) {
+            return string_view();
+        }
+        if (capacity - used < text.size()) {
+            capacity = text.size() > blockSize ? text.size() : blockSize;
+            blocks.push_back(new char[capacity]);
+            used = 0;
+        }
+        char* place = blocks.back() + used;
+        text.copy(place, text.size());
+        used += text.size();
+        return string_view(place, text.size());
+    }
+};
+
+/**
+ * @brief Файл, целиком отображенный в память только для чтения.
+ *
+ * Пока объект жив, на его содержимое можно держать string_view.
+ */
+class MappedFile {
+public:
+    const char* data;  // Начало содержимого файла
+    size_t size;       // Размер файла в байтах
+
+    /**
+     * @brief Отображает файл в память.
+     * @param path Путь к файлу
+     * @throws runtime_error Если файл не удалось открыть
+     */
+    explicit MappedFile(const string& path) : data(nullptr), size(0) {
+#ifdef _WIN32
+        ifstream file(path, ios::binary | ios::ate);
+        if (!file) {
+            throw runtime_error("Cannot open " + path);
+        }
+        size = file.tellg();
+        buffer.reset(new char[size ? size : 1]);
+        file.seekg(0);
+        file.read(buffer.get(), size);
+        data = buffer.get();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) close(fd);
+            throw runtime_error("Cannot open " + path);
+        }
+        size = info.st_size;
+        if (size > 0) {
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("Cannot map " + path);
+            }
+            madvise(mapped, size, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        close(fd);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    unique_ptr<char[]> buffer;
+#endif
 };
 
 class Zoo {
 public:
     vector<Animal> animals;  // Массив животных в зоопарке
+    Pool<Cat> cats;          // Память под котов
+    Pool<Dog> dogs;          // Память под собак
+    Pool<Wombat> wombats;    // Память под вомбатов
+    NameTable names;         // Имена животных
+    vector<unique_ptr<MappedFile>> rosters;  // Загруженные списки, на которые ссылаются имена
+
+    Zoo() {}
+
+    Zoo(const Zoo&) = delete;
+    Zoo& operator=(const Zoo&) = delete;
+
+    /**
+     * @brief Резервирует память еще под заданное количество животных каждого вида.
+     * @param catCount Количество котов
+     * @param dogCount Количество собак
+     * @param wombatCount Количество вомбатов
+     */
+    void reserve(size_t catCount, size_t dogCount, size_t wombatCount) {
+        animals.reserve(animals.size() + catCount + dogCount + wombatCount);
+        cats.reserve(catCount);
+        dogs.reserve(dogCount);
+        wombats.reserve(wombatCount);
+    }
 
     /**
      * @brief Метод для добавления животного в зоопарк.
-     * @param animal Животное для добавления
+     * @param type Тип животного (Cat, Dog, Wombat)
+     * @param name Имя животного, уже хранящееся в таблице имен
+     * @param age Возраст животного
+     * @return false, если тип животного неизвестен
      */
-    void addAnimal(Animal animal) {
-        animals.push_back(animal);
+    bool addAnimal(string_view type, string_view name, int age) {
+        if (type == "Cat") {
+            animals.push_back(Animal(cats.create(name, age), "Cat"));
+        } else if (type == "Dog") {
+            animals.push_back(Animal(dogs.create(name, age), "Dog"));
+        } else if (type == "Wombat") {
+            animals.push_back(Animal(wombats.create(name, age), "Wombat"));
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Загружает список животных из CSV-файла.
+     *
+     * Формат строки: тип,имя,возраст[,сытость,усталость]. Пустые строки и строки,
+     * начинающиеся с '#', пропускаются. Файл отображается в память, имена животных
+     * остаются ссылками на него и не копируются.
+     * @param path Путь к файлу
+     * @return Количество загруженных животных
+     * @throws runtime_error Если файл не удалось открыть
+     */
+    size_t loadRoster(const string& path) {
+        rosters.push_back(unique_ptr<MappedFile>(new MappedFile(path)));
+        const char* begin = rosters.back()->data;
+        const char* end = begin + rosters.back()->size;
+
+        // Первый проход: считаем животных каждого типа, чтобы выделить память один раз
+        size_t counts[3] = {0, 0, 0};
+        for (const char* line = begin; line < end;) {
+            const char* next = static_cast<const char*>(memchr(line, '\n', end - line));
+            next = next ? next + 1 : end;
+            counts[0] += (*line == 'C');
+            counts[1] += (*line == 'D');
+            counts[2] += (*line == 'W');
+            line = next;
+        }
+        reserve(counts[0], counts[1], counts[2]);
+
+        size_t loaded = 0;
+        size_t skipped = 0;
+        for (const char* line = begin; line < end;) {
+            const char* next = static_cast<const char*>(memchr(line, '\n', end - line));
+            const char* lineEnd = next ? next : end;
+            if (parseRosterLine(line, lineEnd)) {
+                ++loaded;
+            } else if (line != lineEnd && *line != '#' && *line != '\r') {
+                ++skipped;
+            }
+            line = next ? next + 1 : end;
+        }
+        if (skipped > 0) {
+            cout << "Roster " << path << ": skipped " << skipped << " malformed lines" << endl;
+        }
+        return loaded;
     }
 
     /**
@@ -178,13 +515,7 @@ public:
             cout << "Enter age: ";
             cin >> age;
 
-            if (type == "Cat") {
-                animals.push_back(Animal(new Cat(name, age), "Cat"));
-            } else if (type == "Dog") {
-                animals.push_back(Animal(new Dog(name, age), "Dog"));
-            } else {
-                animals.push_back(Animal(new Wombat(name, age), "Wombat"));
-            }
+            addAnimal(type, names.intern(name), age);
         } else {
             cout << "Wrong type! Try again..." << endl;
         }
@@ -209,98 +540,416 @@ public:
     }
 
     /**
-     * @brief Метод для моделирования одного рабочего дня зоопарка (12 часов).
+     * @brief Разбирает одну строку списка животных и добавляет животное.
+     * @return false, если строка пустая, комментарий или некорректна (в том числе без имени)
      */
-    void simulateDay() {
-        srand(time(0));
+    bool parseRosterLine(const char* p, const char* end) {
+        if (end > p && end[-1] == '\r') --end;
+        if (p == end || *p == '#') return false;
+
+        string_view fields[5];
+        int count = 0;
+        while (count < 5) {
+            const char* comma = static_cast<const char*>(memchr(p, ',', end - p));
+            const char* fieldEnd = comma ? comma : end;
+            fields[count++] = string_view(p, fieldEnd - p);
+            if (!comma) break;
+            p = comma + 1;
+        }
+        if (count != 3 && count != 5) return false;
+        if (fields[1].empty()) return false;
+
+        int values[3] = {0, 100, 0};
+        for (int i = 2; i < count; ++i) {
+            if (fields[i].empty()) return false;
+            int value = 0;
+            for (char c : fields[i]) {
+                if (c < '0' || c > '9') return false;
+                int digit = c - '0';
+                if (value > (INT_MAX - digit) / 10) return false;
+                value = value * 10 + digit;
+            }
+            values[i - 2] = value;
+        }
+        if (values[1] > 100 || values[2] > 100) return false;
+
+        if (!addAnimal(fields[0], fields[1], values[0])) return false;
+        visit(animals.back(), [&](auto* animal) {
+            animal->fullness = values[1];
+            animal->tiredness = values[2];
+        });
+        return true;
+    }
 
-        for (int hour = 1; hour <= 12; ++hour) {
-            double intensity = rand() / (RAND_MAX + 1.0); // Генерация случайной интенсивности от 0 до 1
-            cout << "\nIntensity hour " << hour << ": " << intensity << endl;
+    /**
+     * @brief Вызывает функцию для конкретного животного, скрытого за указателем на пустоту.
+     * @tparam F Тип вызываемого объекта, принимающего Cat*, Dog* или Wombat*
+     * @param animal Животное
+     * @param f Вызываемый объект
+     */
+    template <typename F>
+    static void visit(Animal& animal, F f) {
+        if (animal.type == "Cat") {
+            f(static_cast<Cat*>(animal.animal));
+        } else if (animal.type == "Dog") {
+            f(static_cast<Dog*>(animal.animal));
+        } else if (animal.type == "Wombat") {
+            f(static_cast<Wombat*>(animal.animal));
+        }
+    }
+};
 
-            for (auto& animal : animals) {
-                if (animal.type == "Cat") {
-                    Cat* cat = static_cast<Cat*>(animal.animal);
-                    cat->passTime(intensity);
-                    checkAnimal(cat, "Cat");
-                } else if (animal.type == "Dog") {
-                    Dog* dog = static_cast<Dog*>(animal.animal);
-                    dog->passTime(intensity);
-                    checkAnimal(dog, "Dog");
-                } else if (animal.type == "Wombat") {
-                    Wombat* wombat = static_cast<Wombat*>(animal.animal);
-                    wombat->passTime(intensity);
-                    checkAnimal(wombat, "Wombat");
+/**
+ * @brief Отдельный вольер (для сна или кормления) с ограниченным количеством мест.
+ */
+class Enclosure {
+public:
+    string name;          // Название вольера
+    int capacity;         // Количество мест
+    int occupied;         // Занятые места
+    deque<int> waiting;   // Очередь животных (индексы в зоопарке), ожидающих места
+
+    int visits;           // Сколько животных побывало в вольере
+    int maxQueue;         // Максимальная длина очереди
+    long long totalWait;  // Суммарное время ожидания (часы)
+    int maxWait;          // Максимальное время ожидания одного животного (часы)
+    long long busyHours;  // Занятые место-часы (для расчета загрузки)
+
+    /**
+     * @brief Конструктор вольера.
+     * @param name Название вольера
+     * @param capacity Количество мест
+     */
+    Enclosure(string name, int capacity)
+        : name(name), capacity(capacity), occupied(0), visits(0), maxQueue(0), totalWait(0), maxWait(0), busyHours(0) {}
+
+    /**
+     * @brief Вывод статистики работы вольера.
+     * @param dayLength Длительность рабочего дня (часы)
+     */
+    void printStatistic(int dayLength) const {
+        cout << name << " enclosure (capacity " << capacity << "): visits " << visits
+             << ", max queue " << maxQueue
+             << ", average wait " << (visits ? (double)totalWait / visits : 0.0) << " h"
+             << ", max wait " << maxWait << " h"
+             << ", utilization " << 100.0 * busyHours / ((long long)capacity * dayLength) << "%" << endl;
+    }
+};
+
+/**
+ * @brief Дискретно-событийная модель рабочего дня смотрителя с вольерами ограниченной вместимости.
+ *
+ * Время событий - целые часы, поэтому список событий - календарная очередь: корзина на
+ * каждый час, постановка и извлечение события стоят O(1). Интенсивность на весь день
+ * разыгрывается заранее, так что для животного на виду сразу известен час, когда оно
+ * устанет или проголодается: на этот час ставится его проверка, а часы между проверками
+ * животных не перебирают. Пока животное ждет места или находится в вольере, оно не
+ * участвует в работе зоопарка.
+ */
+class ZooScheduler {
+public:
+    enum EventType { CHECK, REST_DONE, FEED_DONE };
+    enum AnimalState { ON_DISPLAY, WAITING_REST, RESTING, WAITING_FEED, FEEDING };
+
+    struct Event {
+        EventType type; // Тип события (REST_DONE или FEED_DONE)
+        int animal;     // Индекс животного
+    };
+
+    /**
+     * @brief События одного часа.
+     *
+     * Сначала проверяются животные (по возрастанию индекса), затем освобождаются места
+     * в вольерах в порядке постановки событий.
+     */
+    struct Hour {
+        vector<int> checks;   // Животные, которых нужно проверить
+        vector<Event> done;   // Окончания пребывания в вольерах
+    };
+
+    static const int feedDuration = 1;  // Фиксированное время кормления (часы)
+
+    Zoo& zoo;
+    int dayLength;
+    Enclosure restEnclosure;
+    Enclosure feedEnclosure;
+    vector<unsigned char> state;       // Состояние каждого животного
+    vector<int> queuedAt;              // Время постановки в очередь
+    vector<double> intensity;          // Интенсивность каждого часа (индекс - номер часа)
+    vector<Hour> calendar;             // Корзины событий (индекс - номер часа)
+    bool verbose;                      // Выводить ли сообщения о каждом животном
+
+    /**
+     * @brief Конструктор модели.
+     * @param zoo Зоопарк
+     * @param restCapacity Количество мест в вольере для сна
+     * @param feedCapacity Количество мест в вольере для кормления
+     * @param dayLength Длительность рабочего дня (часы)
+     */
+    ZooScheduler(Zoo& zoo, int restCapacity, int feedCapacity, int dayLength = 12)
+        : zoo(zoo), dayLength(dayLength), restEnclosure("Rest", restCapacity), feedEnclosure("Feeding", feedCapacity),
+          state(zoo.animals.size(), ON_DISPLAY), queuedAt(zoo.animals.size(), 0), intensity(dayLength + 1, 0.0),
+          calendar(dayLength + 1), verbose(zoo.animals.size() <= 100) {}
+
+    /**
+     * @brief Моделирование рабочего дня.
+     */
+    void run() {
+        for (int hour = 1; hour <= dayLength; ++hour) {
+            intensity[hour] = rand() / (RAND_MAX + 1.0);
+        }
+        for (size_t i = 0; i < zoo.animals.size(); ++i) {
+            schedule((int)i, 0);
+        }
+
+        // События ставятся только на будущие часы, поэтому корзина текущего часа уже полна
+        for (int hour = 1; hour <= dayLength; ++hour) {
+            if (verbose) {
+                cout << "\nIntensity hour " << hour << ": " << intensity[hour] << endl;
+            }
+            Hour& events = calendar[hour];
+            sort(events.checks.begin(), events.checks.end());
+            for (int index : events.checks) {
+                check(index, hour);
+            }
+            for (const Event& event : events.done) {
+                if (event.type == REST_DONE) {
+                    release(restEnclosure, hour);
+                    Zoo::visit(zoo.animals[event.animal], [&](auto* animal) {
+                        while (animal->tiredness > 0) {
+                            animal->rest();
+                        }
+                    });
+                } else {
+                    release(feedEnclosure, hour);
+                    Zoo::visit(zoo.animals[event.animal], [&](auto* animal) { animal->eat(); });
                 }
+                state[event.animal] = ON_DISPLAY;
+                returnToDisplay(event.animal, hour);
             }
+            vector<int>().swap(events.checks);
+            vector<Event>().swap(events.done);
         }
     }
 
     /**
-     * @brief Метод для проверки состояния животного (сытость и усталость).
-     * @tparam T Тип животного (Cat, Dog, Wombat)
-     * @param animal Указатель на животное
-     * @param animalType Строка с типом животного
+     * @brief Вывод статистики вольеров за день.
      */
-    template <typename T>
-    void checkAnimal(T* animal, const string& animalType) {
-        if (animal->tiredness > 80) {
-            cout << animalType << " " << animal->name << " tired. Sent to the enclosure for rest." << endl;
-            animal->rest();
+    void printStatistic() const {
+        cout << "\nEnclosure statistics:" << endl;
+        restEnclosure.printStatistic(dayLength);
+        feedEnclosure.printStatistic(dayLength);
+
+        int away = 0;
+        for (unsigned char s : state) {
+            away += (s != ON_DISPLAY);
         }
-        if (animal->fullness < 30) {
-            cout << animalType << " " << animal->name << " hungry. Sent to the enclosure for feeding for one hour." << endl;
-            animal->eat();
+        cout << "Animals still away at the end of the day: " << away << endl;
+    }
+
+private:
+    void push(int time, EventType type, int animal) {
+        if (type == CHECK) {
+            calendar[time].checks.push_back(animal);
+        } else {
+            calendar[time].done.push_back(Event{type, animal});
         }
     }
-};
 
-int main() {
-    Zoo zoo;
+    /**
+     * @brief Планирует проверку животного, которое с часа from находится на виду.
+     *
+     * Животное проживает часы from + 1, from + 2, ... до первого, после которого оно
+     * устало или голодно; на этот час ставится проверка. Состояние животного сразу
+     * продвигается до этого часа (или до конца дня): до проверки его никто не читает.
+     * @param index Индекс животного
+     * @param from Час, с которого животное на виду
+     */
+    void schedule(int index, int from) {
+        Zoo::visit(zoo.animals[index], [&](auto* animal) {
+            for (int hour = from + 1; hour <= dayLength; ++hour) {
+                animal->passTime(intensity[hour]);
+                if (animal->tiredness > 80 || animal->fullness < 30) {
+                    push(hour, CHECK, index);
+                    return;
+                }
+            }
+        });
+    }
 
-    // Запрашиваем у пользователя количество животных
-    int N = 0;
-    while (N < 3) {
-        cout << "Enter number of animals(>3):" << endl;
-        cin >> N;
+    /**
+     * @brief Животное вернулось из вольера: сразу проверяется и, если его не увели снова,
+     * получает следующую проверку.
+     */
+    void returnToDisplay(int index, int now) {
+        check(index, now);
+        if (state[index] == ON_DISPLAY) {
+            schedule(index, now);
+        }
     }
 
-    // Добавляем хотя бы по одному животному каждого типа
-    zoo.addAnimal(Animal(new Cat("Fluffy", rand() % 10 + 1), "Cat"));
-    zoo.addAnimal(Animal(new Dog("Oatmeal", rand() % 10 + 1), "Dog"));
-    zoo.addAnimal(Animal(new Wombat("Kuzmich", rand() % 10 + 1), "Wombat"));
+    /**
+     * @brief Проверка животного смотрителем: уставших отправляют спать, голодных - кормиться.
+     * @param index Индекс животного
+     * @param now Текущее время
+     */
+    void check(int index, int now) {
+        Animal& animal = zoo.animals[index];
+        bool tired = false;
+        bool hungry = false;
+        Zoo::visit(animal, [&](auto* a) {
+            tired = a->tiredness > 80;
+            hungry = a->fullness < 30;
+        });
+
+        if (tired) {
+            state[index] = WAITING_REST;
+            request(restEnclosure, index, now);
+        } else if (hungry) {
+            state[index] = WAITING_FEED;
+            request(feedEnclosure, index, now);
+        }
+    }
 
-    // Заполняем оставшихся животных случайно
-    int n = N - 3;
-    srand(time(0));
-    for (int i = 0; i < n; ++i) {
-        int animalType = rand() % 3; // 0 - Cat, 1 - Dog, 2 - Wombat
-        if (animalType == 0) {
-            zoo.addAnimal(Animal(new Cat("Cat_" + to_string(i + 1), rand() % 10 + 1), "Cat"));
-        } else if (animalType == 1) {
-            zoo.addAnimal(Animal(new Dog("Dog_" + to_string(i + 1), rand() % 10 + 1), "Dog"));
+    /**
+     * @brief Животное встает в очередь вольера или сразу занимает свободное место.
+     */
+    void request(Enclosure& enclosure, int index, int now) {
+        queuedAt[index] = now;
+        if (enclosure.occupied < enclosure.capacity) {
+            admit(enclosure, index, now);
         } else {
-            zoo.addAnimal(Animal(new Wombat("Wombat_" + to_string(i + 1), rand() % 10 + 1), "Wombat"));
+            enclosure.waiting.push_back(index);
+            if ((int)enclosure.waiting.size() > enclosure.maxQueue) {
+                enclosure.maxQueue = enclosure.waiting.size();
+            }
+        }
+    }
+
+    /**
+     * @brief Животное занимает место в вольере, планируется событие окончания.
+     */
+    void admit(Enclosure& enclosure, int index, int now) {
+        Animal& animal = zoo.animals[index];
+        int duration = feedDuration;
+        bool resting = &enclosure == &restEnclosure;
+        if (resting) {
+            Zoo::visit(animal, [&](auto* a) { duration = a->restDuration(); });
+            if (duration < 1) duration = 1;
+        }
+
+        int wait = now - queuedAt[index];
+        ++enclosure.occupied;
+        ++enclosure.visits;
+        enclosure.totalWait += wait;
+        if (wait > enclosure.maxWait) enclosure.maxWait = wait;
+        int end = now + duration;
+        enclosure.busyHours += (end < dayLength ? end : dayLength) - now;
+
+        if (verbose) {
+            Zoo::visit(animal, [&](auto* a) {
+                cout << animal.type << " " << a->name << (resting ? " tired" : " hungry")
+                     << ". Sent to the enclosure for " << (resting ? "rest" : "feeding") << " for " << duration
+                     << " h (waited " << wait << " h)." << endl;
+            });
+        }
+
+        state[index] = resting ? RESTING : FEEDING;
+        if (end <= dayLength) {
+            push(end, resting ? REST_DONE : FEED_DONE, index);
+        }
+    }
+
+    /**
+     * @brief Освобождение места в вольере, место отдается первому в очереди.
+     */
+    void release(Enclosure& enclosure, int now) {
+        --enclosure.occupied;
+        if (!enclosure.waiting.empty()) {
+            int next = enclosure.waiting.front();
+            enclosure.waiting.pop_front();
+            admit(enclosure, next, now);
         }
     }
+};
+
+int main(int argc, char* argv[]) {
+    srand(time(0));
+    Zoo zoo;
+
+    if (argc > 1) {
+        // Загружаем животных из списка, переданного в командной строке
+        for (int i = 1; i < argc; ++i) {
+            clock_t start = clock();
+            try {
+                size_t loaded = zoo.loadRoster(argv[i]);
+                cout << "Loaded " << loaded << " animals from " << argv[i] << " in "
+                     << 1000.0 * (clock() - start) / CLOCKS_PER_SEC << " ms" << endl;
+            } catch (const runtime_error& e) {
+                cerr << e.what() << endl;
+                return 1;
+            }
+        }
+    } else {
+        // Запрашиваем у пользователя количество животных
+        int N = 0;
+        while (N < 3) {
+            cout << "Enter number of animals(>3):" << endl;
+            cin >> N;
+        }
 
-    zoo.printZoo();
+        // Виды остальных животных разыгрываем заранее, чтобы выделить память под каждый вид один раз
+        int n = N - 3;
+        vector<unsigned char> kinds(n);
+        size_t counts[3] = {1, 1, 1};
+        for (int i = 0; i < n; ++i) {
+            kinds[i] = rand() % 3; // 0 - Cat, 1 - Dog, 2 - Wombat
+            ++counts[kinds[i]];
+        }
+        zoo.reserve(counts[0], counts[1], counts[2]);
+
+        // Добавляем хотя бы по одному животному каждого типа
+        zoo.addAnimal("Cat", zoo.names.intern("Fluffy"), rand() % 10 + 1);
+        zoo.addAnimal("Dog", zoo.names.intern("Oatmeal"), rand() % 10 + 1);
+        zoo.addAnimal("Wombat", zoo.names.intern("Kuzmich"), rand() % 10 + 1);
+
+        // Заполняем оставшихся животных случайно
+        const char* types[] = {"Cat", "Dog", "Wombat"};
+        for (int i = 0; i < n; ++i) {
+            const char* type = types[kinds[i]];
+            zoo.addAnimal(type, zoo.names.generate(type, i + 1), rand() % 10 + 1);
+        }
+    }
 
-    // Возможность добавления животных от пользователя
-    char choice;
-    cout << "Want to add a new animal? (y/n): ";
-    cin >> choice;
+    if (argc == 1) {
+        // Список зоопарка и ручное добавление - только для зоопарка, заданного вручную;
+        // загруженные списки бывают на миллионы строк
+        zoo.printZoo();
 
-    while (choice == 'y') {
-        zoo.addAnimalFromUser();
+        // Возможность добавления животных от пользователя
+        char choice;
         cout << "Want to add a new animal? (y/n): ";
         cin >> choice;
-    }
 
-    zoo.printZoo();
+        while (choice == 'y') {
+            zoo.addAnimalFromUser();
+            cout << "Want to add a new animal? (y/n): ";
+            cin >> choice;
+        }
 
-    // Моделирование дня в зоопарке
-    zoo.simulateDay();
+        zoo.printZoo();
+    }
+
+    // Моделирование дня с вольерами ограниченной вместимости
+    int restCapacity = 0;
+    int feedCapacity = 0;
+    while (restCapacity < 1 || feedCapacity < 1) {
+        cout << "\nEnter capacity of the rest and feeding enclosures(>0):" << endl;
+        cin >> restCapacity >> feedCapacity;
+    }
+    ZooScheduler scheduler(zoo, restCapacity, feedCapacity);
+    scheduler.run();
+    scheduler.printStatistic();
 
     return 0;
 }
@@ -2,6 +2,14 @@
 #include <vector>
 #include <ctime>
 #include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <queue>
+#include <atomic>
+#include <climits>
+#include <stdexcept>
 
 using namespace std;
 
@@ -23,6 +31,8 @@ public:
     Spare(int repC, int rC, int rT, int lS)
         : repl_cost(repC), cost_of_one_repair(rC), time_for_repair(rT), service_life(lS), degree_wear(0) {}
 
+    virtual ~Spare() {}
+
     /**
      * @brief Проверяет, сломана ли запчасть.
      * @return true, если запчасть сломана; иначе false.
@@ -161,6 +171,10 @@ public:
         }
     }
 
+    // Станок владеет запчастями, копирование привело бы к двойному удалению
+    Machine(const Machine&) = delete;
+    Machine& operator=(const Machine&) = delete;
+
     /**
      * @brief Метод работы станка: изнашивает запчасти в зависимости от времени и интенсивности.
      * @param intensity Интенсивность работы.
@@ -194,58 +208,1035 @@ public:
     }
 };
 
-int main() {
-    srand(time(0));
+/**
+ * @brief Параметры типов запчастей станка в виде таблиц.
+ *
+ * Заполняется по настоящим объектам Spare, поэтому совпадает с Machine по порядку
+ * запчастей, стоимостям и износу (включая округление износа до целого).
+ */
+class PartTable {
+public:
+    static const int partTypes = 4;      ///< Количество запчастей в станке
+    static const int maxIntensity = 10;  ///< Максимальная интенсивность работы
+
+    int repl_cost[partTypes];
+    int cost_of_one_repair[partTypes];
+    int time_for_repair[partTypes];
+    int service_life[partTypes];
+    int wear[partTypes][maxIntensity + 1];  ///< Износ за час работы при заданной интенсивности
+
+    PartTable() {
+        Machine machine;
+        for (int p = 0; p < partTypes; ++p) {
+            Spare* part = machine.tools[p];
+            repl_cost[p] = part->repl_cost;
+            cost_of_one_repair[p] = part->cost_of_one_repair;
+            time_for_repair[p] = part->time_for_repair;
+            service_life[p] = part->service_life;
+            for (int i = 0; i <= maxIntensity; ++i) {
+                part->degree_wear = 0;
+                part->work(i);
+                wear[p][i] = part->degree_wear;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Счетчиковый генератор случайных чисел: число зависит только от аргументов.
+ *
+ * Не имеет состояния, поэтому одинаково работает в векторизованных циклах и в любом
+ * порядке обхода станков.
+ */
+inline uint32_t randomHash(uint32_t seed, uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t x = seed + a * 0x9E3779B9u + b * 0x85EBCA6Bu + c * 0xC2B2AE35u;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Генератор псевдослучайных чисел SplitMix64 с собственным состоянием.
+ */
+class SplitMix64 {
+public:
+    uint64_t state;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Равномерное число из [0, 1).
+     */
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+/**
+ * @brief Парк станков, хранящий состояние запчастей массивами (структура массивов).
+ *
+ * Каждый станок работает по своим часам до заданного горизонта. За один такт весь
+ * парк продвигается одним циклом без виртуальных вызовов и ветвлений, правила те же,
+ * что в Machine::work: запчасти проверяются по порядку, первая изношенная меняется
+ * (4 часа простоя), иначе с вероятностью 1/100 случается поломка.
+ * Интенсивность меняется каждые 30 дней по 12 часов работы станка.
+ * Для векторизации собирать с -O3 -march=native.
+ */
+class Fleet {
+public:
+    static const int intensityPeriod = 30 * 12;         ///< Часов работы между сменами интенсивности
+    static const uint32_t breakdownThreshold = 42949673u;  ///< 2^32 / 100: вероятность поломки за час
+
+    int size;                                   ///< Количество станков
+    uint32_t seed;                              ///< Зерно случайных чисел
+    vector<int> wear[PartTable::partTypes];     ///< Степень износа каждой запчасти каждого станка
+    vector<int> clock;                          ///< Собственное время каждого станка (часы)
+    vector<int> totalRepairCosts;               ///< Расходы на ремонт
+    vector<int> brokenTime;                     ///< Время простоя
+    vector<int> brokenParts;                    ///< Количество поломок
+    vector<int> replParts;                      ///< Количество замен
+
+    /**
+     * @brief Конструктор парка.
+     * @param size Количество станков
+     * @param seed Зерно случайных чисел
+     */
+    Fleet(int size, uint32_t seed)
+        : size(size), seed(seed), clock(size, 0), totalRepairCosts(size, 0), brokenTime(size, 0),
+          brokenParts(size, 0), replParts(size, 0) {
+        for (auto& w : wear) {
+            w.assign(size, 0);
+        }
+    }
+
+    /**
+     * @brief Интенсивность работы в заданный период (одна для всего парка).
+     * @param period Номер периода
+     */
+    int intensity(int period) const {
+        return intensityFor(seed, period);
+    }
+
+    /**
+     * @brief Интенсивность работы в заданный период для заданного зерна.
+     */
+    static int intensityFor(uint32_t seed, int period) {
+        return randomHash(seed, 0xFFFFFFFFu, period, 0) % PartTable::maxIntensity + 1;
+    }
+
+    /**
+     * @brief Моделирование работы парка, пока каждый станок не отработает horizon часов.
+     * @param horizon Длительность моделирования в часах
+     */
+    void run(int horizon) {
+        const PartTable table;
+        int active = size;
+        for (uint32_t tick = 0; active > 0; ++tick) {
+            active = step(table, tick, horizon, wear[0].data(), wear[1].data(), wear[2].data(), wear[3].data(),
+                          clock.data(), totalRepairCosts.data(), brokenTime.data(), replParts.data(), brokenParts.data());
+        }
+    }
+
+    /**
+     * @brief Поломка станка: какая запчасть и сколько часов занимает ремонт.
+     */
+    struct Breakdown {
+        int part;   ///< Номер запчасти, -1 если станок доработал до горизонта без поломок
+        int hours;  ///< Время ремонта или замены
+    };
+
+    /**
+     * @brief Событийное моделирование: то же, что run, но без почасовых шагов.
+     *
+     * Распределение результатов совпадает с run, конкретные случайные числа - нет.
+     * @param horizon Длительность моделирования в часах
+     */
+    void runEventDriven(int horizon) {
+        const PartTable table;
+        for (int m = 0; m < size; ++m) {
+            SplitMix64 rng = machineRandom(m);
+            for (Breakdown b = nextBreakdown(table, m, horizon, rng); b.part >= 0; b = nextBreakdown(table, m, horizon, rng)) {
+                clock[m] += b.hours;
+                brokenTime[m] += b.hours;
+            }
+        }
+    }
+
+    /**
+     * @brief Собственный генератор случайных чисел станка для событийного моделирования.
+     */
+    SplitMix64 machineRandom(int m) const {
+        return SplitMix64(((uint64_t)seed << 32) | (uint32_t)m);
+    }
+
+    /**
+     * @brief Работа станка до ближайшей поломки или до горизонта.
+     *
+     * Износ детерминирован, поэтому час ближайшего износа запчасти вычисляется сразу,
+     * а число часов без случайных поломок имеет геометрическое распределение.
+     * Станок перескакивает через спокойные часы до ближайшего события (поломка,
+     * износ, смена интенсивности, конец горизонта). Часы станка останавливаются
+     * в начале часа поломки, расходы и счетчики поломок уже учтены, время ремонта - нет.
+     * @param table Параметры запчастей
+     * @param m Номер станка
+     * @param horizon Длительность моделирования в часах
+     * @param rng Генератор случайных чисел станка
+     */
+    Breakdown nextBreakdown(const PartTable& table, int m, int horizon, SplitMix64& rng) {
+        const double p = breakdownThreshold / 4294967296.0;                    // Вероятность поломки запчасти за час
+        static const double calm = pow(1 - p, PartTable::partTypes);           // Вероятность часа без поломок
+        static const double logCalm = log(calm);
+
+        while (clock[m] < horizon) {
+            int level = intensity(clock[m] / intensityPeriod);
+
+            // Через сколько часов какая-то запчасть износится
+            int untilWear = horizon;
+            for (int part = 0; part < PartTable::partTypes; ++part) {
+                int rate = table.wear[part][level];
+                if (rate > 0) {
+                    untilWear = min(untilWear, (table.service_life[part] - wear[part][m] + rate - 1) / rate);
+                }
+            }
+            int boundary = (clock[m] / intensityPeriod + 1) * intensityPeriod;
+            int jump = min(untilWear - 1, min(boundary, horizon) - clock[m]);
+
+            double calmHours = floor(log(1 - rng.uniform()) / logCalm);
+            if (calmHours < jump) {
+                // Спокойные часы, затем час со случайной поломкой одной из запчастей
+                advance(table, m, level, (int)calmHours);
+                double u = rng.uniform() * (1 - calm);
+                int part = 0;
+                double chance = p;
+                while (part < PartTable::partTypes - 1 && u >= chance) {
+                    u -= chance;
+                    chance *= 1 - p;
+                    ++part;
+                }
+                for (int worked = 0; worked <= part; ++worked) {
+                    wear[worked][m] += table.wear[worked][level];  // Следующие запчасти в этот час не работали
+                }
+                totalRepairCosts[m] += table.cost_of_one_repair[part];
+                ++brokenParts[m];
+                return Breakdown{part, table.time_for_repair[part]};
+            }
+
+            advance(table, m, level, jump);
+            if (clock[m] < horizon && clock[m] < boundary) {
+                Breakdown b = stepMachine(table, m, level, rng, p);
+                if (b.part >= 0) {
+                    return b;
+                }
+            }
+        }
+        return Breakdown{-1, 0};
+    }
+
+    /**
+     * @brief Вывод сводной статистики по парку.
+     */
+    void printStatistic() const {
+        long long allRepl = 0, allBrok = 0, allCost = 0, allBrokeTime = 0;
+        int maxBrokeTime = 0;
+        for (int m = 0; m < size; ++m) {
+            allRepl += replParts[m];
+            allBrok += brokenParts[m];
+            allCost += totalRepairCosts[m];
+            allBrokeTime += brokenTime[m];
+            maxBrokeTime = max(maxBrokeTime, brokenTime[m]);
+        }
+        cout << "Fleet of " << size << " machines:" << endl;
+        cout << "\nNumber of replaced parts: " << allRepl << endl;
+        cout << "\nTotal number of breakdowns for all machines: " << allBrok << endl;
+        cout << "\nTotal repair costs: " << allCost << " (" << (double)allCost / size << " per machine)" << endl;
+        cout << "\nTotal downtime of all machines: " << allBrokeTime << " hours" << "(" << allBrokeTime / 24 << " days)" << endl;
+        cout << "\nMaximum total downtime of a single machine: " << maxBrokeTime << " hours" << "(" << maxBrokeTime / 24 << " days)" << endl;
+    }
+
+private:
+    /**
+     * @brief Несколько часов работы станка без событий.
+     */
+    void advance(const PartTable& table, int m, int level, int hours) {
+        for (int part = 0; part < PartTable::partTypes; ++part) {
+            wear[part][m] += hours * table.wear[part][level];
+        }
+        clock[m] += hours;
+    }
+
+    /**
+     * @brief Один час работы станка по правилам Machine::work.
+     * @return Поломка; если ее не было, часы станка сдвигаются на час
+     */
+    Breakdown stepMachine(const PartTable& table, int m, int level, SplitMix64& rng, double p) {
+        for (int part = 0; part < PartTable::partTypes; ++part) {
+            wear[part][m] += table.wear[part][level];
+            if (wear[part][m] >= table.service_life[part]) {
+                wear[part][m] = 0;
+                totalRepairCosts[m] += table.repl_cost[part];
+                ++replParts[m];
+                return Breakdown{part, 4};
+            } else if (rng.uniform() < p) {
+                totalRepairCosts[m] += table.cost_of_one_repair[part];
+                ++brokenParts[m];
+                return Breakdown{part, table.time_for_repair[part]};
+            }
+        }
+        ++clock[m];
+        return Breakdown{-1, 0};
+    }
+
+    /**
+     * @brief Один такт всего парка.
+     *
+     * Массивы передаются как restrict-указатели, а ветвления заменены масками,
+     * чтобы компилятор векторизовал цикл по станкам.
+     * @return Количество станков, еще не отработавших horizon часов
+     */
+    int step(const PartTable& table, uint32_t tick, int horizon,
+             int* __restrict wear0, int* __restrict wear1, int* __restrict wear2, int* __restrict wear3,
+             int* __restrict clocks, int* __restrict costs, int* __restrict downtime,
+             int* __restrict replacedParts, int* __restrict failedParts) const {
+        // Локальные копии таблиц, чтобы они не пересекались с массивами состояния
+        int wearRate[PartTable::partTypes][PartTable::maxIntensity + 1];
+        int life[PartTable::partTypes], replCost[PartTable::partTypes];
+        int repairCost[PartTable::partTypes], repairTime[PartTable::partTypes];
+        for (int p = 0; p < PartTable::partTypes; ++p) {
+            for (int i = 0; i <= PartTable::maxIntensity; ++i) {
+                wearRate[p][i] = table.wear[p][i];
+            }
+            life[p] = table.service_life[p];
+            replCost[p] = table.repl_cost[p];
+            repairCost[p] = table.cost_of_one_repair[p];
+            repairTime[p] = table.time_for_repair[p];
+        }
+        const int count = size;
+        const uint32_t key = seed;
+
+        for (int m = 0; m < count; ++m) {
+            int running = clocks[m] < horizon;
+            // То же, что intensity(), но без обращения к полям объекта внутри цикла
+            int level = randomHash(key, 0xFFFFFFFFu, clocks[m] / intensityPeriod, 0) % PartTable::maxIntensity + 1;
+            int done = !running;
+            int hours = 0;
+            int cost = 0;
+            int broken = 0;
+            int replaced = 0;
+            const uint32_t id = m;
+            auto part = [&](int p, int& wear) {
+                int w = wear + (1 - done) * wearRate[p][level];
+                int wornOut = !done & (w >= life[p]);
+                int failed = !done & !wornOut & (randomHash(key, id, tick, p) < breakdownThreshold);
+                wear = wornOut ? 0 : w;
+                hours += wornOut * 4 + failed * repairTime[p];
+                cost += wornOut * replCost[p] + failed * repairCost[p];
+                replaced += wornOut;
+                broken += failed;
+                done |= wornOut | failed;
+            };
+            part(0, wear0[m]);
+            part(1, wear1[m]);
+            part(2, wear2[m]);
+            part(3, wear3[m]);
+            clocks[m] += running ? (hours > 0 ? hours : 1) : 0;
+            downtime[m] += hours;
+            costs[m] += cost;
+            replacedParts[m] += replaced;
+            failedParts[m] += broken;
+        }
+
+        int active = 0;
+        for (int m = 0; m < count; ++m) {
+            active += clocks[m] < horizon;
+        }
+        return active;
+    }
+};
+
+/**
+ * @brief Потоковая оценка квантиля алгоритмом P^2 (Jain, Chlamtac) за O(1) памяти.
+ */
+class P2Quantile {
+public:
+    /**
+     * @brief Конструктор.
+     * @param p Уровень квантиля (0..1)
+     */
+    explicit P2Quantile(double p) : p(p), count(0) {
+        increments[0] = 0;
+        increments[1] = p / 2;
+        increments[2] = p;
+        increments[3] = (1 + p) / 2;
+        increments[4] = 1;
+    }
 
-    int daysInYear = 365;                       // Количество дней в году
-    int numberOfMachines = 5;                   // Количество станков
-    int allRepl = 0;                            // Общее количество замененных частей
-    int allBrok = 0;                            // Общее количество поломок
-    int arrBrok[numberOfMachines] = {0};        // Массив поломок для каждого станка
-    int arrCost[numberOfMachines] = {0};        // Массив расходов на ремонт для каждого станка
-    int allBrokeTime = 0;                       // Общее время простоя
-    int arrBrokeTime[numberOfMachines] = {0};   // Массив времени простоя для каждого станка
+    /**
+     * @brief Добавление наблюдения.
+     * @param x Значение
+     */
+    void add(double x) {
+        if (count < 5) {
+            heights[count++] = x;
+            if (count == 5) {
+                sort(heights, heights + 5);
+                for (int i = 0; i < 5; ++i) {
+                    positions[i] = i;
+                }
+                desired[0] = 0;
+                desired[1] = 2 * p;
+                desired[2] = 4 * p;
+                desired[3] = 2 + 2 * p;
+                desired[4] = 4;
+            }
+            return;
+        }
 
-    std::vector<Machine> machines(numberOfMachines);
+        int k;
+        if (x < heights[0]) {
+            heights[0] = x;
+            k = 0;
+        } else if (x >= heights[4]) {
+            heights[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (x >= heights[k + 1]) {
+                ++k;
+            }
+        }
+        for (int i = k + 1; i < 5; ++i) {
+            ++positions[i];
+        }
+        for (int i = 0; i < 5; ++i) {
+            desired[i] += increments[i];
+        }
 
-    int hours = 12 * 365;
-    int h_old = hours;
-    int intensity = rand() % 10 + 1;
-    while (hours > 0){
-        if (h_old - hours >= 30 * 12){
-            intensity = rand() % 10 + 1;
-            h_old = hours;
+        for (int i = 1; i < 4; ++i) {
+            double d = desired[i] - positions[i];
+            if ((d >= 1 && positions[i + 1] - positions[i] > 1) || (d <= -1 && positions[i - 1] - positions[i] < -1)) {
+                int step = d >= 0 ? 1 : -1;
+                double candidate = parabolic(i, step);
+                if (heights[i - 1] < candidate && candidate < heights[i + 1]) {
+                    heights[i] = candidate;
+                } else {
+                    heights[i] += step * (heights[i + step] - heights[i]) / (positions[i + step] - positions[i]);
+                }
+                positions[i] += step;
+            }
         }
-        for (auto& machine : machines) {           
-            hours -= machine.work(intensity);
+        ++count;
+    }
+
+    /**
+     * @brief Текущая оценка квантиля.
+     */
+    double value() const {
+        if (count == 0) {
+            return 0;
         }
+        if (count < 5) {
+            double sorted[5];
+            for (int i = 0; i < count; ++i) {
+                double x = heights[i];
+                int j = i;
+                while (j > 0 && sorted[j - 1] > x) {
+                    sorted[j] = sorted[j - 1];
+                    --j;
+                }
+                sorted[j] = x;
+            }
+            return sorted[min(count - 1, (int)(p * count))];
+        }
+        return heights[2];
     }
 
-    int i = 0;
-    for (auto& machine : machines) {           
-            allRepl += machine.replParts;
-            allBrok += machine.brokenParts;
-            arrBrok[i] += machine.brokenParts;
-            arrCost[i] += machine.totalRepairCosts;
-            allBrokeTime += machine.brokenTime;
-            arrBrokeTime[i] += machine.brokenTime;
-            i++;
+private:
+    double p;
+    int count;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+
+    double parabolic(int i, int d) const {
+        double left = positions[i] - positions[i - 1];
+        double right = positions[i + 1] - positions[i];
+        return heights[i] + d / (positions[i + 1] - positions[i - 1]) *
+               ((left + d) * (heights[i + 1] - heights[i]) / right + (right - d) * (heights[i] - heights[i - 1]) / left);
     }
+};
 
-    cout << "One year operation statistics:" << endl;
-    cout << "\nNumber of replaced parts: " << allRepl << endl; // сломались по сроку службу
-    cout << "\nNumber of breakdowns for each machine:" << endl; // сломались неожиданно
-    for (int i = 0; i < numberOfMachines; ++i) {
-        cout << i+1 << ". " << arrBrok[i] << endl;
+/**
+ * @brief Потоковая статистика: среднее и дисперсия (метод Уэлфорда), квантили 5%, 50%, 95%.
+ */
+class StreamingStats {
+public:
+    long long count = 0;
+    double mean = 0;
+    double m2 = 0;  ///< Сумма квадратов отклонений от среднего
+    double minValue = 0;
+    double maxValue = 0;
+    P2Quantile p05{0.05};
+    P2Quantile p50{0.5};
+    P2Quantile p95{0.95};
+
+    /**
+     * @brief Добавление наблюдения.
+     * @param x Значение
+     */
+    void add(double x) {
+        ++count;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        minValue = count == 1 ? x : min(minValue, x);
+        maxValue = count == 1 ? x : max(maxValue, x);
+        p05.add(x);
+        p50.add(x);
+        p95.add(x);
     }
-    cout << "\nTotal number of breakdowns for all machines: " << allBrok << endl; // сломались неожиданно
-    cout << "\nRepair costs for each machine:" << endl;
-    for (int i = 0; i < numberOfMachines; ++i) {
-        cout << i+1 << ". " << arrCost[i] << endl;
+
+    double variance() const {
+        return count > 1 ? m2 / (count - 1) : 0;
     }
-    cout << "\nTotal downtime of all machines: " << allBrokeTime << " hours" << "(" << allBrokeTime / 24 << " days)" << endl;
-    int* maxElement = max_element(arrBrokeTime, arrBrokeTime + numberOfMachines);
-    cout << "\nMaximum total downtime of a single machine: " << *maxElement << " hours" << "(" << *maxElement / 24 << " days)" << endl;
 
-    return 0;
+    /**
+     * @brief Полуширина 95% доверительного интервала для среднего.
+     */
+    double confidence95() const {
+        return count > 1 ? 1.96 * sqrt(variance() / count) : 0;
+    }
+
+    /**
+     * @brief Вывод одной строки отчета.
+     * @param title Подпись
+     */
+    void print(const string& title) const {
+        cout << title << ": mean " << mean << " +- " << confidence95()
+             << " (sd " << sqrt(variance()) << ", p5 " << p05.value() << ", median " << p50.value()
+             << ", p95 " << p95.value() << ", min " << minValue << ", max " << maxValue << ")" << endl;
+    }
+};
+
+/**
+ * @brief Параллельный метод Монте-Карло по годам работы парка станков.
+ *
+ * Каждый год моделируется отдельным Fleet со своим зерном, полученным из общего зерна
+ * и номера года, поэтому результат не зависит от количества потоков. Годы считаются
+ * пачками параллельно, а в статистику добавляются строго по порядку номеров.
+ */
+class MonteCarlo {
+public:
+    static const int batchSize = 4096;  ///< Годов в одной пачке
+
+    int years;              ///< Количество моделируемых лет
+    int machines;           ///< Станков в парке
+    int horizon;            ///< Часов работы станка за год
+    uint32_t seed;          ///< Общее зерно
+    int threads;            ///< Количество потоков
+    bool eventDriven;       ///< Использовать событийное моделирование вместо почасового
+    vector<StreamingStats> cost;      ///< Расходы на ремонт каждого станка за год
+    vector<StreamingStats> downtime;  ///< Простой каждого станка за год
+    StreamingStats fleetCost;         ///< Расходы всего парка за год
+    StreamingStats fleetDowntime;     ///< Простой всего парка за год
+
+    MonteCarlo(int years, int machines, int horizon, uint32_t seed, int threads, bool eventDriven = false)
+        : years(years), machines(machines), horizon(horizon), seed(seed), threads(max(1, threads)),
+          eventDriven(eventDriven), cost(machines), downtime(machines) {}
+
+    /**
+     * @brief Зерно отдельного года.
+     * @param year Номер года
+     */
+    uint32_t yearSeed(int year) const {
+        return randomHash(seed, year, 0x5EEDu, 1);
+    }
+
+    void run() {
+        vector<int> yearCost((size_t)batchSize * machines);
+        vector<int> yearDowntime((size_t)batchSize * machines);
+
+        for (int first = 0; first < years; first += batchSize) {
+            int count = min(batchSize, years - first);
+            auto worker = [&](int t) {
+                for (int y = t; y < count; y += threads) {
+                    Fleet fleet(machines, yearSeed(first + y));
+                    if (eventDriven) {
+                        fleet.runEventDriven(horizon);
+                    } else {
+                        fleet.run(horizon);
+                    }
+                    copy(fleet.totalRepairCosts.begin(), fleet.totalRepairCosts.end(), yearCost.begin() + (size_t)y * machines);
+                    copy(fleet.brokenTime.begin(), fleet.brokenTime.end(), yearDowntime.begin() + (size_t)y * machines);
+                }
+            };
+            vector<thread> pool;
+            for (int t = 1; t < threads; ++t) {
+                pool.emplace_back(worker, t);
+            }
+            worker(0);
+            for (auto& th : pool) {
+                th.join();
+            }
+
+            for (int y = 0; y < count; ++y) {
+                long long totalCost = 0, totalDowntime = 0;
+                for (int m = 0; m < machines; ++m) {
+                    int c = yearCost[(size_t)y * machines + m];
+                    int d = yearDowntime[(size_t)y * machines + m];
+                    cost[m].add(c);
+                    downtime[m].add(d);
+                    totalCost += c;
+                    totalDowntime += d;
+                }
+                fleetCost.add(totalCost);
+                fleetDowntime.add(totalDowntime);
+            }
+        }
+    }
+
+    void printReport() const {
+        cout << "Monte Carlo over " << years << " years (" << machines << " machines, "
+             << horizon << " hours each, seed " << seed << "):" << endl;
+        for (int m = 0; m < machines && m < 20; ++m) {
+            cout << "\nMachine " << m + 1 << ":" << endl;
+            cost[m].print("  Repair costs");
+            downtime[m].print("  Downtime, hours");
+        }
+        cout << "\nWhole fleet:" << endl;
+        fleetCost.print("  Repair costs");
+        fleetDowntime.print("  Downtime, hours");
+    }
+};
+
+/**
+ * @brief Политика обслуживания: плановые осмотры и предупредительная замена запчастей.
+ *
+ * На осмотре запчасть, износ которой достиг доли threshold от срока службы, меняется
+ * заранее. Плановая замена стоит столько же, сколько замена по износу, но занимает
+ * plannedHours вместо 4 часов аварийного простоя.
+ */
+class MaintenancePolicy {
+public:
+    static const int plannedHours = 1;     ///< Простой на плановую замену одной запчасти
+    static const int inspectionCost = 10;  ///< Стоимость одного осмотра
+
+    double threshold[PartTable::partTypes];  ///< Порог замены (доля от срока службы), 1 - работать до износа
+    int inspectionInterval;                  ///< Часов работы между осмотрами, 0 - без осмотров
+
+    MaintenancePolicy() : inspectionInterval(0) {
+        fill(threshold, threshold + PartTable::partTypes, 1.0);
+    }
+
+    /**
+     * @brief Моделирование одного года работы станка с этой политикой.
+     *
+     * Случайные поломки зависят только от зерна, часа работы станка и номера запчасти,
+     * поэтому разные политики с одним зерном сравниваются на общих случайных числах.
+     * @param table Параметры запчастей
+     * @param seed Зерно
+     * @param horizon Часов работы
+     * @param cost Расходы за год
+     * @param downtime Простой за год
+     */
+    void simulate(const PartTable& table, uint32_t seed, int horizon, long long& cost, long long& downtime) const {
+        int wear[PartTable::partTypes] = {0};
+        int limit[PartTable::partTypes];
+        for (int p = 0; p < PartTable::partTypes; ++p) {
+            limit[p] = (int)ceil(threshold[p] * table.service_life[p]);
+        }
+        int nextInspection = inspectionInterval > 0 ? inspectionInterval : INT_MAX;
+        int clock = 0;
+        cost = 0;
+        downtime = 0;
+
+        while (clock < horizon) {
+            if (clock >= nextInspection) {
+                cost += inspectionCost;
+                for (int p = 0; p < PartTable::partTypes; ++p) {
+                    if (wear[p] >= limit[p]) {
+                        wear[p] = 0;
+                        cost += table.repl_cost[p];
+                        downtime += plannedHours;
+                        clock += plannedHours;
+                    }
+                }
+                while (nextInspection <= clock) {
+                    nextInspection += inspectionInterval;
+                }
+            }
+
+            int level = Fleet::intensityFor(seed, clock / Fleet::intensityPeriod);
+            int hours = 1;
+            for (int p = 0; p < PartTable::partTypes; ++p) {
+                wear[p] += table.wear[p][level];
+                if (wear[p] >= table.service_life[p]) {
+                    wear[p] = 0;
+                    hours = 4;
+                    cost += table.repl_cost[p];
+                    downtime += 4;
+                    break;
+                } else if (randomHash(seed, clock, p, 7) < Fleet::breakdownThreshold) {
+                    hours = table.time_for_repair[p];
+                    cost += table.cost_of_one_repair[p];
+                    downtime += hours;
+                    break;
+                }
+            }
+            clock += hours;
+        }
+    }
+
+    /**
+     * @brief Краткое описание политики.
+     */
+    string describe() const {
+        if (inspectionInterval == 0) {
+            return "run to failure";
+        }
+        string text = "inspect every " + to_string(inspectionInterval) + " h, replace at";
+        for (int p = 0; p < PartTable::partTypes; ++p) {
+            text += " " + to_string((int)lround(threshold[p] * 100)) + "%";
+        }
+        return text;
+    }
+};
+
+/**
+ * @brief Подбор политики обслуживания перебором порогов замены и интервалов осмотров.
+ *
+ * Каждая политика оценивается на одних и тех же годах (общие случайные числа),
+ * политики распределяются между потоками, результат не зависит от их количества.
+ * Выводится фронт Парето по средним расходам и простою.
+ */
+class PolicyOptimizer {
+public:
+    struct Result {
+        MaintenancePolicy policy;
+        double cost;      ///< Средние расходы за год
+        double downtime;  ///< Средний простой за год
+    };
+
+    int years;      ///< Лет моделирования на одну политику
+    int horizon;    ///< Часов работы станка за год
+    uint32_t seed;  ///< Общее зерно
+    int threads;    ///< Количество потоков
+    vector<Result> results;
+
+    PolicyOptimizer(int years, int horizon, uint32_t seed, int threads)
+        : years(years), horizon(horizon), seed(seed), threads(max(1, threads)) {}
+
+    /**
+     * @brief Перебор сетки политик.
+     * @param thresholds Возможные пороги замены для каждого типа запчасти
+     * @param intervals Возможные интервалы осмотров
+     */
+    void sweep(const vector<double>& thresholds, const vector<int>& intervals) {
+        results.clear();
+        results.push_back(Result{MaintenancePolicy(), 0, 0});
+        for (int interval : intervals) {
+            int combinations = 1;
+            for (int p = 0; p < PartTable::partTypes; ++p) {
+                combinations *= thresholds.size();
+            }
+            for (int c = 0; c < combinations; ++c) {
+                MaintenancePolicy policy;
+                policy.inspectionInterval = interval;
+                for (int p = 0, rest = c; p < PartTable::partTypes; ++p, rest /= thresholds.size()) {
+                    policy.threshold[p] = thresholds[rest % thresholds.size()];
+                }
+                results.push_back(Result{policy, 0, 0});
+            }
+        }
+
+        const PartTable table;
+        atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < results.size(); i = next++) {
+                long long totalCost = 0, totalDowntime = 0;
+                for (int y = 0; y < years; ++y) {
+                    long long cost, downtime;
+                    results[i].policy.simulate(table, randomHash(seed, y, 0x9011C7u, 2), horizon, cost, downtime);
+                    totalCost += cost;
+                    totalDowntime += downtime;
+                }
+                results[i].cost = (double)totalCost / years;
+                results[i].downtime = (double)totalDowntime / years;
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& th : pool) {
+            th.join();
+        }
+    }
+
+    /**
+     * @brief Политики, которые нельзя улучшить по расходам, не ухудшив простой.
+     */
+    vector<Result> paretoFront() const {
+        vector<Result> sorted = results;
+        sort(sorted.begin(), sorted.end(), [](const Result& a, const Result& b) {
+            return a.cost != b.cost ? a.cost < b.cost : a.downtime < b.downtime;
+        });
+        vector<Result> front;
+        for (const Result& r : sorted) {
+            if (front.empty() || r.downtime < front.back().downtime) {
+                front.push_back(r);
+            }
+        }
+        return front;
+    }
+
+    void printReport() const {
+        cout << "Evaluated " << results.size() << " policies on " << years << " years each (seed " << seed << ")" << endl;
+        cout << "\nBaseline (" << results[0].policy.describe() << "): cost " << results[0].cost
+             << ", downtime " << results[0].downtime << " h" << endl;
+        cout << "\nPareto front (cost vs downtime):" << endl;
+        for (const Result& r : paretoFront()) {
+            cout << "cost " << r.cost << ", downtime " << r.downtime << " h - " << r.policy.describe() << endl;
+        }
+    }
+};
+
+/**
+ * @brief Цех с ограниченным числом ремонтных бригад.
+ *
+ * Каждый станок живет по своим часам: работает до поломки (событийно, через
+ * Fleet::nextBreakdown), затем ждет свободную бригаду и ремонтируется. Ожидающие
+ * станки обслуживаются через очередь с приоритетом: сначала самые короткие ремонты,
+ * при равенстве - кто раньше сломался. События хранятся в двоичной куче.
+ */
+class RepairShop {
+public:
+    struct Event {
+        int time;        ///< Время события
+        long long seq;   ///< Порядковый номер для стабильного порядка
+        bool repaired;   ///< true - ремонт закончен, false - станок сломался
+        int machine;     ///< Номер станка
+
+        bool operator>(const Event& other) const {
+            return time != other.time ? time > other.time : seq > other.seq;
+        }
+    };
+
+    struct Request {
+        int hours;       ///< Длительность ремонта
+        int time;        ///< Время поломки
+        int machine;     ///< Номер станка
+
+        bool operator>(const Request& other) const {
+            if (hours != other.hours) return hours > other.hours;
+            return time != other.time ? time > other.time : machine > other.machine;
+        }
+    };
+
+    Fleet& fleet;
+    int crews;                   ///< Количество бригад
+    int horizon;                 ///< Длительность моделирования в часах
+    vector<int> waitTime;        ///< Суммарное ожидание бригады каждым станком
+    vector<int> brokenAt;        ///< Время последней поломки станка
+    vector<Fleet::Breakdown> pending;  ///< Текущая поломка станка
+    long long busyHours;         ///< Бригадо-часы ремонта в пределах горизонта
+    int maxQueue;                ///< Максимальная очередь на ремонт
+
+    RepairShop(Fleet& fleet, int crews, int horizon)
+        : fleet(fleet), crews(max(1, crews)), horizon(horizon), waitTime(fleet.size, 0), brokenAt(fleet.size, 0),
+          pending(fleet.size), busyHours(0), maxQueue(0), seq(0), freeCrews(this->crews) {}
+
+    void run() {
+        const PartTable table;
+        vector<SplitMix64> random;
+        random.reserve(fleet.size);
+        for (int m = 0; m < fleet.size; ++m) {
+            random.push_back(fleet.machineRandom(m));
+            breakDown(table, m, random[m]);
+        }
+
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            int m = event.machine;
+
+            if (!event.repaired) {
+                waiting.push(Request{pending[m].hours, event.time, m});
+                maxQueue = max(maxQueue, (int)waiting.size());
+            } else {
+                // Станок снова работает со времени окончания ремонта
+                fleet.brokenTime[m] += event.time - brokenAt[m];
+                fleet.clock[m] = event.time;
+                ++freeCrews;
+                breakDown(table, m, random[m]);
+            }
+
+            while (freeCrews > 0 && !waiting.empty()) {
+                Request request = waiting.top();
+                waiting.pop();
+                --freeCrews;
+                waitTime[request.machine] += event.time - request.time;
+                busyHours += max(0, min(event.time + request.hours, horizon) - event.time);
+                push(event.time + request.hours, true, request.machine);
+            }
+        }
+    }
+
+    void printStatistic() const {
+        long long allWait = 0;
+        int maxWait = 0;
+        for (int w : waitTime) {
+            allWait += w;
+            maxWait = max(maxWait, w);
+        }
+        cout << "\nRepair crews: " << crews << ", utilization "
+             << 100.0 * busyHours / ((double)crews * horizon) << "%" << endl;
+        cout << "\nTotal waiting for a crew: " << allWait << " hours" << "(" << allWait / 24 << " days)" << endl;
+        cout << "\nMaximum waiting of a single machine: " << maxWait << " hours" << endl;
+        cout << "\nMaximum repair queue: " << maxQueue << " machines" << endl;
+    }
+
+private:
+    long long seq;
+    int freeCrews;
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+    priority_queue<Request, vector<Request>, greater<Request>> waiting;
+
+    void push(int time, bool repaired, int machine) {
+        events.push(Event{time, seq++, repaired, machine});
+    }
+
+    /**
+     * @brief Станок работает до следующей поломки, поломка ставится в календарь событий.
+     */
+    void breakDown(const PartTable& table, int m, SplitMix64& rng) {
+        pending[m] = fleet.nextBreakdown(table, m, horizon, rng);
+        if (pending[m].part >= 0) {
+            brokenAt[m] = fleet.clock[m];
+            push(fleet.clock[m], false, m);
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc > 1 && string(argv[1]) == "optimize") {
+            // Подбор политики обслуживания: optimize [лет на политику] [зерно] [потоков]
+            int years = argc > 2 ? stoi(argv[2]) : 100;
+            uint32_t seed = argc > 3 ? stoul(argv[3]) : time(0);
+            int threads = argc > 4 ? stoi(argv[4]) : thread::hardware_concurrency();
+            if (years < 1) {
+                cerr << "Number of years must be positive" << endl;
+                return 1;
+            }
+            PolicyOptimizer optimizer(years, 12 * 365, seed, threads);
+            optimizer.sweep({0.7, 0.8, 0.9, 1.0}, {24, 72, 168, 360});
+            optimizer.printReport();
+            return 0;
+        }
+
+        if (argc > 1 && string(argv[1]) == "montecarlo") {
+            // Режим Монте-Карло: montecarlo [лет] [зерно] [потоков] [step|events]
+            int years = argc > 2 ? stoi(argv[2]) : 10000;
+            uint32_t seed = argc > 3 ? stoul(argv[3]) : time(0);
+            int threads = argc > 4 ? stoi(argv[4]) : thread::hardware_concurrency();
+            bool events = argc > 5 && string(argv[5]) == "events";
+            if (years < 1) {
+                cerr << "Number of years must be positive" << endl;
+                return 1;
+            }
+            MonteCarlo experiment(years, 5, 12 * 365, seed, threads, events);
+            experiment.run();
+            experiment.printReport();
+            return 0;
+        }
+
+        if (argc > 1 && string(argv[1]) == "fleet") {
+            // Режим парка: fleet [количество станков] [часов работы каждого] [step|events] [зерно]
+            int size = argc > 2 ? stoi(argv[2]) : 100000;
+            int horizon = argc > 3 ? stoi(argv[3]) : 24 * 365;
+            bool events = argc > 4 && string(argv[4]) == "events";
+            uint32_t seed = argc > 5 ? stoul(argv[5]) : time(0);
+            if (size < 1 || horizon < 1) {
+                cerr << "Number of machines and hours must be positive" << endl;
+                return 1;
+            }
+            Fleet fleet(size, seed);
+            clock_t start = clock();
+            if (events) {
+                fleet.runEventDriven(horizon);
+            } else {
+                fleet.run(horizon);
+            }
+            double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+            fleet.printStatistic();
+            cout << "\nSimulated " << size << " machines x " << horizon << " hours in " << seconds << " s" << endl;
+            return 0;
+        }
+
+        // Каждый станок работает по своим часам, ремонт ждет свободную бригаду: [бригад] [станков] [часов]
+        int crews = argc > 1 ? stoi(argv[1]) : 2;                   // Количество ремонтных бригад
+        int numberOfMachines = argc > 2 ? stoi(argv[2]) : 5;        // Количество станков
+        int hours = argc > 3 ? stoi(argv[3]) : 12 * 365;            // Часов работы каждого станка за год
+        if (crews < 1 || numberOfMachines < 1 || hours < 1) {
+            cerr << "Number of crews, machines and hours must be positive" << endl;
+            return 1;
+        }
+        int allRepl = 0;                            // Общее количество замененных частей
+        int allBrok = 0;                            // Общее количество поломок
+        vector<int> arrBrok(numberOfMachines);      // Массив поломок для каждого станка
+        vector<int> arrCost(numberOfMachines);      // Массив расходов на ремонт для каждого станка
+        long long allBrokeTime = 0;                 // Общее время простоя
+        vector<int> arrBrokeTime(numberOfMachines); // Массив времени простоя для каждого станка
+
+        Fleet machines(numberOfMachines, time(0));
+        RepairShop shop(machines, crews, hours);
+        clock_t start = clock();
+        shop.run();
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        for (int i = 0; i < numberOfMachines; ++i) {
+            allRepl += machines.replParts[i];
+            allBrok += machines.brokenParts[i];
+            arrBrok[i] += machines.brokenParts[i];
+            arrCost[i] += machines.totalRepairCosts[i];
+            allBrokeTime += machines.brokenTime[i];
+            arrBrokeTime[i] += machines.brokenTime[i];
+        }
+
+        cout << "One year operation statistics:" << endl;
+        cout << "\nNumber of replaced parts: " << allRepl << endl; // сломались по сроку службу
+        cout << "\nNumber of breakdowns for each machine:" << endl; // сломались неожиданно
+        for (int i = 0; i < numberOfMachines && i < 20; ++i) {
+            cout << i+1 << ". " << arrBrok[i] << endl;
+        }
+        cout << "\nTotal number of breakdowns for all machines: " << allBrok << endl; // сломались неожиданно
+        cout << "\nRepair costs for each machine:" << endl;
+        for (int i = 0; i < numberOfMachines && i < 20; ++i) {
+            cout << i+1 << ". " << arrCost[i] << endl;
+        }
+        cout << "\nTotal downtime of all machines: " << allBrokeTime << " hours" << "(" << allBrokeTime / 24 << " days)" << endl;
+        int maxElement = *max_element(arrBrokeTime.begin(), arrBrokeTime.end());
+        cout << "\nMaximum total downtime of a single machine: " << maxElement << " hours" << "(" << maxElement / 24 << " days)" << endl;
+        shop.printStatistic();
+        cout << "\nSimulated in " << seconds << " s" << endl;
+
+        return 0;
+    } catch (const invalid_argument&) {
+        cerr << "Arguments must be numbers" << endl;
+    } catch (const out_of_range&) {
+        cerr << "Argument is out of range" << endl;
+    }
+    return 1;
 }
@@ -3,6 +3,165 @@
 #include <cmath>
 #include <string>
 #include <ctime>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+/**
+ * @brief Генератор PCG32 (XSH RR): 64 бита состояния, 32 бита на выходе.
+ */
+class Pcg32 {
+public:
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    explicit Pcg32(uint64_t seed, uint64_t stream = 0x14057B7EF767814Full) : state(0), increment((stream << 1) | 1) {
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    result_type operator()() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ull + increment;
+        uint32_t shifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rotation = (uint32_t)(old >> 59);
+        return (shifted >> rotation) | (shifted << ((32 - rotation) & 31));
+    }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+/**
+ * @brief Генератор xoshiro256** (Blackman, Vigna): 256 бит состояния, 64 бита на выходе.
+ */
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~0ull; }
+
+    explicit Xoshiro256(uint64_t seed) {
+        // Состояние заполняется через SplitMix64, как рекомендуют авторы
+        for (uint64_t& word : s) {
+            uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    result_type operator()() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+/**
+ * @brief Счетчиковый генератор Philox4x32-10 (Salmon и др.).
+ *
+ * Выход - шифр от (ключ, номер блока), поэтому поток с заданным ключом можно
+ * начать с любого места без прогона предыдущих чисел.
+ */
+class Philox4x32 {
+public:
+    using result_type = uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    explicit Philox4x32(uint64_t seed, uint64_t block = 0) : index(4) {
+        key[0] = (uint32_t)seed;
+        key[1] = (uint32_t)(seed >> 32);
+        counter[0] = (uint32_t)block;
+        counter[1] = (uint32_t)(block >> 32);
+        counter[2] = counter[3] = 0;
+    }
+
+    result_type operator()() {
+        if (index == 4) {
+            generate();
+            index = 0;
+        }
+        return output[index++];
+    }
+
+private:
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t output[4];
+    int index;
+
+    void generate() {
+        uint32_t c[4] = {counter[0], counter[1], counter[2], counter[3]};
+        uint32_t k[2] = {key[0], key[1]};
+        for (int round = 0; round < 10; ++round) {
+            uint64_t product0 = (uint64_t)0xD2511F53u * c[0];
+            uint64_t product1 = (uint64_t)0xCD9E8D57u * c[2];
+            uint32_t next[4] = {(uint32_t)(product1 >> 32) ^ c[1] ^ k[0], (uint32_t)product1,
+                                (uint32_t)(product0 >> 32) ^ c[3] ^ k[1], (uint32_t)product0};
+            std::copy(next, next + 4, c);
+            k[0] += 0x9E3779B9u;
+            k[1] += 0xBB67AE85u;
+        }
+        std::copy(c, c + 4, output);
+        // Следующий блок: 128-битный счетчик
+        for (int i = 0; i < 4 && ++counter[i] == 0; ++i) {}
+    }
+};
+
+/**
+ * @brief Равномерное число из [0, 1) с 53 случайными битами.
+ * @param rng Генератор с 32- или 64-битным выходом.
+ */
+template <typename Rng>
+double uniform01(Rng& rng) {
+    if (std::is_same<typename Rng::result_type, uint64_t>::value && Rng::max() == ~0ull) {
+        return (uint64_t(rng()) >> 11) * (1.0 / 9007199254740992.0);
+    }
+    uint64_t high = uint32_t(rng()) >> 5;
+    uint64_t low = uint32_t(rng()) >> 6;
+    return (high * 67108864.0 + low) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Генератор, которым пользуется стрельбище (выбран по замеру rngbench).
+ */
+using RangeRandom = Xoshiro256;
+
+/**
+ * @brief Зерно отдельного потока случайных чисел из общего зерна и номеров задачи.
+ */
+inline uint64_t streamSeed(uint64_t seed, uint64_t a, uint64_t b) {
+    return seed * 0x9E3779B97F4A7C15ull ^ (a + 1) * 0xBF58476D1CE4E5B9ull ^ (b + 1) * 0x94D049BB133111EBull;
+}
 
 /**
  * @brief Абстрактный класс для оружия.
@@ -20,6 +179,8 @@ public:
     double effectiveRange;   // Прицельная дальность
     int accuracy;            // Кучность стрельбы
     int modifications;       // Количество устанавливаемых модификаций
+    static const int hitTableRange = 2000;  // До какой дистанции (м) шанс попадания хранится в таблице
+    std::vector<double> hitTable;           // Шанс попадания на целых дистанциях 0..hitTableRange
 
     /**
      * @brief Конструктор для создания оружия.
@@ -34,7 +195,12 @@ public:
      * @param mods Количество модификаций.
      */
     Weapon(std::string n, double cal, int maxA, double reloadT, int fireM, double wt, double effR, int acc, int mods)
-        : name(n), caliber(cal), maxAmmo(maxA), reloadTime(reloadT), fireModes(fireM), weight(wt), effectiveRange(effR), accuracy(acc), modifications(mods), currentAmmo(maxA) {}
+        : name(n), caliber(cal), maxAmmo(maxA), reloadTime(reloadT), fireModes(fireM), weight(wt), effectiveRange(effR), accuracy(acc), modifications(mods), currentAmmo(maxA) {
+        hitTable.resize(hitTableRange + 1);
+        for (int d = 0; d <= hitTableRange; ++d) {
+            hitTable[d] = calculateHitChance(d);
+        }
+    }
 
     /**
      * @brief Перезарядка оружия.
@@ -48,6 +214,13 @@ public:
      */
     virtual int fire(double distance, int mode) = 0;
 
+    /**
+     * @brief Копия оружия вместе с его текущим состоянием.
+     */
+    virtual std::unique_ptr<Weapon> clone() const = 0;
+
+    virtual ~Weapon() {}
+
     /**
      * @brief Вывод характеристик оружия.
      */
@@ -68,9 +241,51 @@ public:
      * @return Шанс попадания в процентах.
      */
     double calculateHitChance(double distance) const {
-        double ratio = distance / effectiveRange;
+        return hitChanceFor(distance, effectiveRange);
+    }
+
+    /**
+     * @brief Шанс попадания для оружия с заданной прицельной дальностью.
+     * @param distance Расстояние до мишени.
+     * @param range Прицельная дальность.
+     * @return Шанс попадания в процентах.
+     */
+    static double hitChanceFor(double distance, double range) {
+        double ratio = distance / range;
         return (ratio < 0.2) ? 100 : (100 * std::exp(-10 * ratio));
     }
+
+    /**
+     * @brief Шанс попадания из таблицы (для целых дистанций) без вычисления экспоненты.
+     * @param distance Расстояние до мишени.
+     * @return Шанс попадания в процентах.
+     */
+    double hitChance(double distance) const {
+        int d = (int)distance;
+        if (d == distance && d >= 0 && d <= hitTableRange) {
+            return hitTable[d];
+        }
+        return calculateHitChance(distance);
+    }
+
+    /**
+     * @brief Серия выстрелов без перезарядки.
+     *
+     * Шанс попадания вычисляется один раз, число попаданий разыгрывается сразу
+     * биномиальным распределением вместо отдельного броска на каждый выстрел.
+     * @param distance Расстояние до мишени.
+     * @param n Сколько выстрелов сделать (не больше, чем патронов в магазине).
+     * @param rng Генератор случайных чисел (любой UniformRandomBitGenerator).
+     * @return Количество попаданий.
+     */
+    template <typename Rng>
+    int fireMany(double distance, int n, Rng& rng) {
+        int shots = std::min(n, currentAmmo);
+        if (shots <= 0) return 0;
+        currentAmmo -= shots;
+        std::binomial_distribution<int> hits(shots, hitChance(distance) / 100);
+        return hits(rng);
+    }
 };
 
 /**
@@ -101,6 +316,10 @@ public:
         double hitChance = calculateHitChance(distance);
         return (rand() % 100) < hitChance ? 1 : 0;
     }
+
+    std::unique_ptr<Weapon> clone() const override {
+        return std::unique_ptr<Weapon>(new Pistol(*this));
+    }
 };
 
 /**
@@ -131,6 +350,10 @@ public:
         double hitChance = calculateHitChance(distance);
         return (rand() % 100) < hitChance ? 1 : 0;
     }
+
+    std::unique_ptr<Weapon> clone() const override {
+        return std::unique_ptr<Weapon>(new BoltActionRifle(*this));
+    }
 };
 
 /**
@@ -161,6 +384,10 @@ public:
         double hitChance = calculateHitChance(distance);
         return (rand() % 100) < hitChance ? 1 : 0;
     }
+
+    std::unique_ptr<Weapon> clone() const override {
+        return std::unique_ptr<Weapon>(new PumpShotgun(*this));
+    }
 };
 
 /**
@@ -169,11 +396,12 @@ public:
 class ShootingRange {
 public:
     std::vector<double> targets;  // Мишени с разными дистанциями
+    RangeRandom rng;              // Генератор случайных чисел для стрельбы сериями
 
     /**
      * @brief Конструктор для создания стрельбища с мишенями.
      */
-    ShootingRange() {
+    ShootingRange() : rng(time(0)) {
         for (int i = 10; i <= 1000; i *= 2) {
             targets.push_back(i);
         }
@@ -193,12 +421,15 @@ public:
             int totalShots = 100;
             double totalTime = 0;
 
-            for (int i = 0; i < totalShots; ++i) {
+            // Стреляем сериями до опустошения магазина
+            for (int fired = 0; fired < totalShots;) {
                 if (weapon.currentAmmo == 0){
                     totalTime += weapon.reload();
                 }
-                hits += weapon.fire(distance, 1);
-                totalTime += 0.7;               
+                int shots = std::min(totalShots - fired, weapon.currentAmmo);
+                hits += weapon.fireMany(distance, shots, rng);
+                totalTime += 0.7 * shots;
+                fired += shots;
             }
             double accuracy = (double) hits / totalShots * 100;
             double fireRate = totalShots / totalTime * 60;
@@ -208,12 +439,577 @@ public:
     }
 };
 
+/**
+ * @brief Аналитическая модель времени стрельбы.
+ *
+ * Повторяет правила ShootingRange::simulate: перед выстрелом пустое оружие
+ * перезаряжается, каждый выстрел занимает shotTime. Тогда время N выстрелов,
+ * начатых с ammo патронами, равно N * shotTime + R * reload, где
+ * R = ceil(max(0, N - ammo) / capacity) - число перезарядок.
+ */
+class FireModel {
+public:
+    static constexpr double shotTime = 0.7;  // Время одного выстрела, с
+
+    int capacity;   // Патронов в полном магазине
+    double reload;  // Время перезарядки пустого оружия
+
+    FireModel(int capacity, double reload) : capacity(capacity), reload(reload) {}
+
+    /**
+     * @brief Модель для конкретного оружия; время перезарядки берется из его reload().
+     */
+    static FireModel of(const Weapon& weapon) {
+        std::unique_ptr<Weapon> copy = weapon.clone();
+        copy->currentAmmo = 0;
+        return FireModel(weapon.maxAmmo, copy->reload());
+    }
+
+    /**
+     * @brief Количество перезарядок за n выстрелов.
+     * @param n Количество выстрелов.
+     * @param ammo Патронов в магазине перед стрельбой.
+     */
+    long long reloads(long long n, int ammo) const {
+        return n <= ammo ? 0 : (n - ammo + capacity - 1) / capacity;
+    }
+
+    /**
+     * @brief Время n выстрелов с учетом перезарядок.
+     */
+    double timeForShots(long long n, int ammo) const {
+        return n * shotTime + reloads(n, ammo) * reload;
+    }
+
+    /**
+     * @brief Скорострельность (выстрелов в минуту) для серии из n выстрелов.
+     */
+    double fireRate(long long n, int ammo) const {
+        return n / timeForShots(n, ammo) * 60;
+    }
+
+    /**
+     * @brief Патронов в магазине после n выстрелов.
+     */
+    int ammoAfter(long long n, int ammo) const {
+        return n <= ammo ? ammo - n : (int)(capacity - 1 - (n - ammo - 1) % capacity);
+    }
+
+    /**
+     * @brief Математическое ожидание времени до hits попаданий.
+     *
+     * Число выстрелов S до hits-го попадания имеет отрицательное биномиальное
+     * распределение: E[S] = hits / p, а E[R] = сумма по k >= 0 вероятностей
+     * P(S > ammo + k * capacity), каждая из которых - хвост биномиального распределения.
+     * @param hits Нужное количество попаданий.
+     * @param p Вероятность попадания одним выстрелом.
+     * @param ammo Патронов в магазине перед стрельбой.
+     */
+    double expectedTimeToHits(int hits, double p, int ammo) const {
+        if (hits <= 0) return 0;
+        if (p <= 0) return std::numeric_limits<double>::infinity();
+        double expectedReloads = 0;
+        for (long long m = ammo;; m += capacity) {
+            double tail = fewerHits(m, hits, p);
+            expectedReloads += tail;
+            if (tail < 1e-12 && m * p > hits) break;
+        }
+        return hits / p * shotTime + expectedReloads * reload;
+    }
+
+private:
+    /**
+     * @brief P(Bin(m, p) < hits): вероятность набрать меньше hits попаданий за m выстрелов.
+     */
+    static double fewerHits(long long m, int hits, double p) {
+        if (m < hits) return 1;
+        if (p >= 1) return 0;
+        double sum = 0;
+        for (int j = 0; j < hits; ++j) {
+            sum += std::exp(std::lgamma(m + 1.0) - std::lgamma(j + 1.0) - std::lgamma(m - j + 1.0)
+                            + j * std::log(p) + (m - j) * std::log1p(-p));
+        }
+        return std::min(1.0, sum);
+    }
+};
+
+/**
+ * @brief Сверка аналитической модели с пошаговой симуляцией (эталоном).
+ * @param weapons Проверяемые оружия.
+ * @param distances Дистанции мишеней.
+ */
+void validateFireModel(const std::vector<Weapon*>& weapons, const std::vector<double>& distances) {
+    RangeRandom rng(12345);
+    const int shots = 100;
+    const int hitsNeeded = 10;
+    const int trials = 20000;
+
+    for (Weapon* original : weapons) {
+        FireModel model = FireModel::of(*original);
+        std::cout << "\n" << original->name << " (capacity " << model.capacity << ", reload " << model.reload << " s)\n";
+
+        // Скорострельность: та же последовательность дистанций, что в simulate, патроны переходят между ними
+        std::unique_ptr<Weapon> weapon = original->clone();
+        int ammo = weapon->currentAmmo;
+        double worst = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t d = 0; d < distances.size(); ++d) {
+            double totalTime = 0;
+            for (int i = 0; i < shots; ++i) {
+                if (weapon->currentAmmo == 0) totalTime += weapon->reload();
+                weapon->fire(distances[d], 1);
+                totalTime += FireModel::shotTime;
+            }
+            worst = std::max(worst, std::fabs(shots / totalTime * 60 - model.fireRate(shots, ammo)));
+            ammo = model.ammoAfter(shots, ammo);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        volatile double sink = 0;
+        for (size_t d = 0; d < distances.size(); ++d) sink = sink + model.fireRate(shots, model.capacity);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "  Fire rate: max |analytic - simulated| = " << worst << " shots/min"
+                  << ", simulation " << std::chrono::duration<double, std::micro>(middle - start).count() << " us"
+                  << ", analytic " << std::chrono::duration<double, std::micro>(end - middle).count() << " us\n";
+
+        // Время до hitsNeeded попаданий: среднее по симуляциям против формулы
+        for (double distance : distances) {
+            double p = original->hitChance(distance) / 100;
+            if (p < 0.05) continue;
+            double sum = 0;
+            for (int t = 0; t < trials; ++t) {
+                weapon->currentAmmo = weapon->maxAmmo;
+                int hits = 0;
+                double time = 0;
+                while (hits < hitsNeeded) {
+                    if (weapon->currentAmmo == 0) time += weapon->reload();
+                    hits += weapon->fireMany(distance, 1, rng);
+                    time += FireModel::shotTime;
+                }
+                sum += time;
+            }
+            std::cout << "  " << distance << "m: time to " << hitsNeeded << " hits - analytic "
+                      << model.expectedTimeToHits(hitsNeeded, p, model.capacity) << " s, simulated " << sum / trials << " s\n";
+        }
+    }
+}
+
+/**
+ * @brief Замер способа стрельбы: скорость одиночных выстрелов и отклонение точности от формулы.
+ *
+ * Для каждой дистанции делается shots выстрелов; отклонение выражено в стандартных
+ * ошибках (|z|), у качественного генератора оно почти никогда не превышает 4.
+ * @param title Название.
+ * @param weapon Оружие.
+ * @param distances Дистанции мишеней.
+ * @param shots Выстрелов на каждую дистанцию.
+ * @param hit Функция выстрела: по шансу попадания в процентах возвращает попадание.
+ */
+template <typename Hit>
+void measureShots(const std::string& title, const Weapon& weapon, const std::vector<double>& distances, long long shots, Hit hit) {
+    double worstZ = 0, worstError = 0, seconds = 0;
+    long long total = 0;
+    for (double distance : distances) {
+        double chance = weapon.hitChance(distance);
+        double p = chance / 100;
+        long long hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < shots; ++i) {
+            hits += hit(chance);
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += shots;
+        double error = (double)hits / shots - p;
+        double sd = std::sqrt(p * (1 - p) / shots);
+        worstError = std::max(worstError, std::fabs(error));
+        if (sd > 0) worstZ = std::max(worstZ, std::fabs(error) / sd);
+    }
+    std::cout << std::left << std::setw(14) << title << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+              << total / seconds / 1e6 << " M shots/s" << std::setprecision(5) << "   max |error| " << worstError
+              << std::setprecision(2) << "   max |z| " << worstZ << "\n" << std::defaultfloat << std::setprecision(6);
+}
+
+/**
+ * @brief Замер генератора: выстрел - сравнение равномерного числа из [0, 1) с вероятностью.
+ */
+template <typename Rng>
+void benchmarkGenerator(const std::string& title, const Weapon& weapon, const std::vector<double>& distances, long long shots, Rng& rng) {
+    measureShots(title, weapon, distances, shots, [&rng](double chance) { return uniform01(rng) < chance / 100; });
+}
+
+/**
+ * @brief Сравнение генераторов случайных чисел для стрельбища.
+ *
+ * Дистанции выбираются так, чтобы шанс попадания был дробным, на них видна
+ * погрешность старого сравнения rand() % 100 < шанс.
+ */
+void benchmarkGenerators(long long shots) {
+    BoltActionRifle rifle;
+    std::vector<double> distances;
+    for (double d = 170; d <= 600; d += 43) {
+        distances.push_back(d);
+    }
+    std::cout << "Generators on " << rifle.name << ", " << distances.size() << " distances x " << shots << " shots:\n";
+
+    // Старый способ: rand() % 100 сравнивается с дробным процентом
+    measureShots("rand() % 100", rifle, distances, shots, [](double chance) { return (rand() % 100) < chance; });
+
+    std::mt19937 mt(42);
+    benchmarkGenerator("mt19937", rifle, distances, shots, mt);
+    std::mt19937_64 mt64(42);
+    benchmarkGenerator("mt19937_64", rifle, distances, shots, mt64);
+    Pcg32 pcg(42);
+    benchmarkGenerator("PCG32", rifle, distances, shots, pcg);
+    Xoshiro256 xoshiro(42);
+    benchmarkGenerator("xoshiro256**", rifle, distances, shots, xoshiro);
+    Philox4x32 philox(42);
+    benchmarkGenerator("Philox4x32-10", rifle, distances, shots, philox);
+}
+
+/**
+ * @brief Параллельный прогон испытаний: все оружия x все дистанции x много повторов.
+ *
+ * Каждый повтор - 100 выстрелов, как в ShootingRange::simulate. Повтор начинается
+ * со случайного числа патронов в магазине (от 0 до полного): в simulate патроны
+ * переходят от мишени к мишени, так что стрелок подходит к рубежу с начатым
+ * магазином, и от этого зависит число перезарядок. Число попаданий разыгрывается
+ * одним биномиальным броском на повтор, а скорострельность берется из FireModel;
+ * пошаговый цикл остался только в validateFireModel для сверки. Повторы разбиты
+ * на задачи фиксированного размера, у каждой задачи свой генератор, зерно которого
+ * зависит только от номера задачи, поэтому результат не зависит от количества потоков.
+ */
+class TrialRunner {
+public:
+    static const int shotsPerTrial = 100;  // Выстрелов в одном повторе
+    static const int trialsPerTask = 256;  // Повторов в одной задаче
+
+    /**
+     * @brief Статистика по одной паре оружие-дистанция.
+     */
+    struct Cell {
+        double accuracyMean = 0, accuracySd = 0, accuracyMin = 0, accuracyMax = 0;
+        double fireRateMean = 0, fireRateSd = 0, fireRateMin = 0, fireRateMax = 0;
+    };
+
+    std::vector<Weapon*> weapons;
+    std::vector<double> distances;
+    int trials;
+    unsigned seed;
+    int threads;
+    std::vector<Cell> table;  // Результаты, индекс = оружие * количество дистанций + дистанция
+
+    TrialRunner(const std::vector<Weapon*>& weapons, const std::vector<double>& distances, int trials, unsigned seed, int threads)
+        : weapons(weapons), distances(distances), trials(trials), seed(seed), threads(std::max(1, threads)) {}
+
+    void run() {
+        int cells = weapons.size() * distances.size();
+        int tasksPerCell = (trials + trialsPerTask - 1) / trialsPerTask;
+        std::vector<double> accuracy((size_t)cells * trials);
+        std::vector<double> fireRate((size_t)cells * trials);
+        std::vector<FireModel> models;
+        for (Weapon* weapon : weapons) {
+            models.push_back(FireModel::of(*weapon));
+        }
+
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int task = next++; task < cells * tasksPerCell; task = next++) {
+                int cell = task / tasksPerCell;
+                int first = task % tasksPerCell * trialsPerTask;
+                int last = std::min(trials, first + trialsPerTask);
+                const Weapon& weapon = *weapons[cell / distances.size()];
+                const FireModel& model = models[cell / distances.size()];
+                std::binomial_distribution<int> hits(shotsPerTrial, weapon.hitChance(distances[cell % distances.size()]) / 100);
+                std::uniform_int_distribution<int> startAmmo(0, model.capacity);
+                RangeRandom rng(streamSeed(seed, cell, first));
+
+                for (int t = first; t < last; ++t) {
+                    accuracy[(size_t)cell * trials + t] = (double)hits(rng) / shotsPerTrial * 100;
+                    fireRate[(size_t)cell * trials + t] = model.fireRate(shotsPerTrial, startAmmo(rng));
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& th : pool) {
+            th.join();
+        }
+
+        table.assign(cells, Cell());
+        for (int cell = 0; cell < cells; ++cell) {
+            summarize(&accuracy[(size_t)cell * trials], trials, table[cell].accuracyMean, table[cell].accuracySd,
+                      table[cell].accuracyMin, table[cell].accuracyMax);
+            summarize(&fireRate[(size_t)cell * trials], trials, table[cell].fireRateMean, table[cell].fireRateSd,
+                      table[cell].fireRateMin, table[cell].fireRateMax);
+        }
+    }
+
+    /**
+     * @brief Вывод сводной таблицы по всем оружиям.
+     */
+    void printTable() const {
+        std::cout << "\nStatistics over " << trials << " trials of " << shotsPerTrial << " shots:\n";
+        std::cout << std::left << std::setw(20) << "Weapon" << std::setw(10) << "Distance"
+                  << std::right << std::setw(38) << "Accuracy, % (mean +- sd [min, max])"
+                  << std::setw(48) << "Fire rate, shots/min (mean +- sd [min, max])" << "\n";
+        for (size_t w = 0; w < weapons.size(); ++w) {
+            for (size_t d = 0; d < distances.size(); ++d) {
+                const Cell& c = table[w * distances.size() + d];
+                std::cout << std::left << std::setw(20) << weapons[w]->name << std::setw(10) << distances[d]
+                          << std::right << std::setw(38) << spread(c.accuracyMean, c.accuracySd, c.accuracyMin, c.accuracyMax)
+                          << std::setw(48) << spread(c.fireRateMean, c.fireRateSd, c.fireRateMin, c.fireRateMax) << "\n";
+            }
+        }
+    }
+
+    /**
+     * @brief Форматирует столбец таблицы: "mean +- sd [min, max]" с двумя знаками.
+     */
+    static std::string spread(double mean, double sd, double low, double high) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << mean << " +- " << sd << " [" << low << ", " << high << "]";
+        return out.str();
+    }
+
+    /**
+     * @brief Среднее, стандартное отклонение, минимум и максимум массива.
+     */
+    static void summarize(const double* values, int trials, double& mean, double& sd, double& low, double& high) {
+        double sum = 0, squares = 0;
+        if (trials <= 0) {
+            mean = sd = low = high = 0;
+            return;
+        }
+        low = high = values[0];
+        for (int i = 0; i < trials; ++i) {
+            sum += values[i];
+            squares += values[i] * values[i];
+            low = std::min(low, values[i]);
+            high = std::max(high, values[i]);
+        }
+        mean = sum / trials;
+        sd = trials > 1 ? std::sqrt(std::max(0.0, (squares - sum * mean) / (trials - 1))) : 0;
+    }
+};
+
+/**
+ * @brief Способ перезарядки оружия.
+ */
+enum class ReloadStrategy {
+    MAGAZINE,   // Съемный магазин: замена целиком за reloadTime
+    PER_ROUND   // По одному патрону: reloadTime на каждый патрон до заполнения
+};
+
+/**
+ * @brief Каталог оружия, загружаемый из файла, в виде структуры массивов.
+ *
+ * Строка файла: название,калибр,патронов,время перезарядки,режимов стрельбы,вес,
+ * прицельная дальность,кучность,модификаций,magazine|per-round.
+ * Пустые строки и строки, начинающиеся с '#', пропускаются.
+ */
+class WeaponTable {
+public:
+    std::vector<std::string> name;
+    std::vector<double> caliber;
+    std::vector<int> maxAmmo;
+    std::vector<double> reloadTime;
+    std::vector<int> fireModes;
+    std::vector<double> weight;
+    std::vector<double> effectiveRange;
+    std::vector<int> accuracy;
+    std::vector<int> modifications;
+    std::vector<ReloadStrategy> strategy;
+
+    /**
+     * @brief Количество записей в каталоге.
+     */
+    int size() const {
+        return name.size();
+    }
+
+    /**
+     * @brief Загрузка каталога из файла.
+     * @param path Путь к файлу.
+     * @throws std::runtime_error Если файл не открывается или строка некорректна.
+     */
+    void load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot open catalog " + path);
+        }
+        std::string line;
+        for (int number = 1; std::getline(file, line); ++number) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            for (std::string field; std::getline(stream, field, ',');) {
+                fields.push_back(field);
+            }
+            if (fields.size() != 10) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": expected 10 fields");
+            }
+            try {
+                name.push_back(fields[0]);
+                caliber.push_back(std::stod(fields[1]));
+                maxAmmo.push_back(std::stoi(fields[2]));
+                reloadTime.push_back(std::stod(fields[3]));
+                fireModes.push_back(std::stoi(fields[4]));
+                weight.push_back(std::stod(fields[5]));
+                effectiveRange.push_back(std::stod(fields[6]));
+                accuracy.push_back(std::stoi(fields[7]));
+                modifications.push_back(std::stoi(fields[8]));
+            } catch (const std::logic_error&) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": bad number");
+            }
+            if (fields[9] == "magazine") {
+                strategy.push_back(ReloadStrategy::MAGAZINE);
+            } else if (fields[9] == "per-round") {
+                strategy.push_back(ReloadStrategy::PER_ROUND);
+            } else {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": unknown reload strategy " + fields[9]);
+            }
+            if (maxAmmo.back() < 1 || effectiveRange.back() <= 0) {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": bad weapon parameters");
+            }
+        }
+    }
+};
+
+/**
+ * @brief Испытания всего каталога на стрельбище.
+ *
+ * Способ перезарядки выбирается один раз на запись каталога (шаблонный параметр),
+ * а не виртуальным вызовом на каждый выстрел. Записи распределяются между потоками.
+ */
+class CatalogRange {
+public:
+    const WeaponTable& catalog;
+    std::vector<double> distances;
+    int trials;
+    unsigned seed;
+    int threads;
+    std::vector<TrialRunner::Cell> table;  // Индекс = запись * количество дистанций + дистанция
+
+    CatalogRange(const WeaponTable& catalog, const std::vector<double>& distances, int trials, unsigned seed, int threads)
+        : catalog(catalog), distances(distances), trials(trials), seed(seed), threads(std::max(1, threads)) {}
+
+    void run() {
+        table.assign(catalog.size() * distances.size(), TrialRunner::Cell());
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            std::vector<double> accuracy(trials), fireRate(trials);
+            for (int i = next++; i < catalog.size(); i = next++) {
+                for (size_t d = 0; d < distances.size(); ++d) {
+                    RangeRandom rng(streamSeed(seed, i, d));
+                    if (catalog.strategy[i] == ReloadStrategy::MAGAZINE) {
+                        simulate<ReloadStrategy::MAGAZINE>(i, distances[d], rng, accuracy, fireRate);
+                    } else {
+                        simulate<ReloadStrategy::PER_ROUND>(i, distances[d], rng, accuracy, fireRate);
+                    }
+                    TrialRunner::Cell& c = table[i * distances.size() + d];
+                    TrialRunner::summarize(accuracy.data(), trials, c.accuracyMean, c.accuracySd, c.accuracyMin, c.accuracyMax);
+                    TrialRunner::summarize(fireRate.data(), trials, c.fireRateMean, c.fireRateSd, c.fireRateMin, c.fireRateMax);
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& th : pool) {
+            th.join();
+        }
+    }
+
+    void printTable() const {
+        std::cout << "\nCatalog statistics over " << trials << " trials of " << TrialRunner::shotsPerTrial << " shots:\n";
+        std::cout << std::left << std::setw(24) << "Weapon" << std::setw(10) << "Distance"
+                  << std::setw(14) << "Accuracy, %" << "Fire rate, shots/min\n";
+        for (int i = 0; i < catalog.size(); ++i) {
+            for (size_t d = 0; d < distances.size(); ++d) {
+                const TrialRunner::Cell& c = table[i * distances.size() + d];
+                std::cout << std::left << std::setw(24) << catalog.name[i] << std::setw(10) << distances[d]
+                          << std::fixed << std::setprecision(2) << std::setw(14) << c.accuracyMean << c.fireRateMean << "\n"
+                          << std::defaultfloat << std::setprecision(6);
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Время перезарядки пустого оружия.
+     */
+    template <ReloadStrategy S>
+    double emptyReloadTime(int i) const {
+        return S == ReloadStrategy::MAGAZINE ? catalog.reloadTime[i] : catalog.reloadTime[i] * catalog.maxAmmo[i];
+    }
+
+    /**
+     * @brief Повторы стрельбы по одной мишени, как в ShootingRange::simulate, с полного магазина.
+     *
+     * Попадания - один биномиальный бросок на повтор, скорострельность - по FireModel.
+     */
+    template <ReloadStrategy S>
+    void simulate(int i, double distance, RangeRandom& rng, std::vector<double>& accuracy, std::vector<double>& fireRate) const {
+        const int shotsPerTrial = TrialRunner::shotsPerTrial;
+        const FireModel model(catalog.maxAmmo[i], emptyReloadTime<S>(i));
+        std::binomial_distribution<int> hits(shotsPerTrial, Weapon::hitChanceFor(distance, catalog.effectiveRange[i]) / 100);
+
+        for (int t = 0; t < trials; ++t) {
+            accuracy[t] = (double)hits(rng) / shotsPerTrial * 100;
+            fireRate[t] = model.fireRate(shotsPerTrial, model.capacity);
+        }
+    }
+};
+
 /**
  * @brief Главная функция программы.
  */
-int main() {
+int main(int argc, char* argv[]) {
     srand(time(0));
 
+    if (argc > 1 && std::string(argv[1]) == "rngbench") {
+        // Замер генераторов случайных чисел: rngbench [выстрелов на дистанцию]
+        benchmarkGenerators(argc > 2 ? std::stoll(argv[2]) : 10000000);
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "validate") {
+        // Сверка аналитической модели времени стрельбы с симуляцией
+        Pistol pistol;
+        BoltActionRifle rifle;
+        PumpShotgun shotgun;
+        ShootingRange range;
+        validateFireModel({&pistol, &rifle, &shotgun}, range.targets);
+        return 0;
+    }
+
+    if (argc > 1) {
+        // Испытание каталога оружия из файла
+        WeaponTable catalog;
+        try {
+            catalog.load(argv[1]);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        int trialCount = argc > 2 ? std::atoi(argv[2]) : 1000;
+        if (trialCount < 1) {
+            std::cerr << "Trial count must be positive: " << argv[2] << std::endl;
+            return 1;
+        }
+        ShootingRange range;
+        CatalogRange trials(catalog, range.targets, trialCount, time(0), std::thread::hardware_concurrency());
+        trials.run();
+        trials.printTable();
+        return 0;
+    }
+
     Pistol pistol;
     BoltActionRifle rifle;
     PumpShotgun shotgun;
@@ -224,5 +1020,10 @@ int main() {
     range.simulate(rifle);
     range.simulate(shotgun);
 
+    // Сводная статистика по всем оружиям
+    TrialRunner runner({&pistol, &rifle, &shotgun}, range.targets, 1000, time(0), std::thread::hardware_concurrency());
+    runner.run();
+    runner.printTable();
+
     return 0;
 }
\ No newline at end of file
@@ -1,4 +1,19 @@
 #include <iostream>
+#include <new>
+#include <chrono>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <stdexcept>
 
 
 template<typename T>
@@ -9,6 +24,10 @@ public:
         Element* next;  // Указатель на следующий элемент.
 
         Element(const T& value) : data(value), next(nullptr) {}
+        Element(T&& value) : data(std::move(value)), next(nullptr) {}
+
+        template<typename... Args>
+        Element(std::in_place_t, Args&&... args) : data(std::forward<Args>(args)...), next(nullptr) {}
     };
 
     Element* start_element;  // Указатель на начало очереди.
@@ -28,34 +47,89 @@ public:
      * @param value Значение, которое нужно добавить в очередь.
      */
     void enqueue(const T& value) {
-        Element* newElement = new Element(value);
+        link(new Element(value));
+    }
+
+    /**
+     * @brief Добавление элемента в конец очереди перемещением.
+     * @param value Значение, которое будет перемещено в очередь.
+     */
+    void enqueue(T&& value) {
+        link(new Element(std::move(value)));
+    }
+
+    /**
+     * @brief Создание элемента прямо в конце очереди.
+     * @param args Аргументы конструктора T.
+     * @return Ссылка на созданный элемент.
+     */
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        Element* newElement = new Element(std::in_place, std::forward<Args>(args)...);
+        link(newElement);
+        return newElement->data;
+    }
+
+    /**
+     * @brief Добавление диапазона элементов одной операцией.
+     *
+     * Цепочка собирается отдельно и присоединяется к очереди целиком, поэтому
+     * при исключении в конструкторе T очередь остается прежней.
+     * @param first Начало диапазона.
+     * @param last Конец диапазона.
+     */
+    template<typename InputIt>
+    void enqueue_range(InputIt first, InputIt last) {
+        Element* chainStart = nullptr;
+        Element* chainEnd = nullptr;
+        int count = 0;
+        try {
+            for (; first != last; ++first) {
+                Element* newElement = new Element(*first);
+                if (chainEnd) {
+                    chainEnd->next = newElement;
+                } else {
+                    chainStart = newElement;
+                }
+                chainEnd = newElement;
+                ++count;
+            }
+        } catch (...) {
+            while (chainStart) {
+                Element* temp = chainStart;
+                chainStart = chainStart->next;
+                delete temp;
+            }
+            throw;
+        }
+        if (!chainStart) {
+            return;
+        }
         if (isEmpty()) {
-            start_element = end_element = newElement;
+            start_element = chainStart;
         } else {
-            end_element->next = newElement;
-            end_element = newElement;
+            end_element->next = chainStart;
         }
-        ++size;
+        end_element = chainEnd;
+        size += count;
     }
 
     /**
      * @brief Удаление элемента из начала очереди.
-     * 
-     * Если очередь пуста, выводится сообщение об ошибке.
+     * @return false, если очередь пуста.
      */
-    void dequeue() {
+    bool dequeue() {
         if (isEmpty()) {
-            std::cerr << "Queue is empty!\n";
-        }else{
-            Element* temp = start_element;
-            start_element = start_element->next;
-            delete temp;
-            --size;
-            if (isEmpty()) {
-                end_element = nullptr;
-            }  
+            return false;
         }
-        
+        Element* temp = start_element;
+        start_element = start_element->next;
+        delete temp;
+        --size;
+        if (isEmpty()) {
+            end_element = nullptr;
+        }
+        return true;
     }
 
     /**
@@ -65,12 +139,59 @@ public:
      */
     T* peek() const {
         if (isEmpty()) {
-            std::cerr << "Queue is empty!\n";
             return nullptr;
         }
         return &start_element->data;
     }
 
+    /**
+     * @brief Извлечение элемента из начала очереди перемещением в out.
+     *
+     * Ничего не выводит; если присваивание T бросит исключение, очередь не меняется.
+     * @return false, если очередь пуста.
+     */
+    bool try_pop(T& out) {
+        if (isEmpty()) {
+            return false;
+        }
+        out = std::move(start_element->data);
+        dequeue();
+        return true;
+    }
+
+    /**
+     * @brief Извлечение элемента из начала очереди.
+     * @return Элемент или std::nullopt, если очередь пуста.
+     */
+    std::optional<T> pop() {
+        if (isEmpty()) {
+            return std::nullopt;
+        }
+        std::optional<T> result(std::move(start_element->data));
+        dequeue();
+        return result;
+    }
+
+    /**
+     * @brief Извлечение до n элементов из начала очереди.
+     *
+     * Каждый узел отсоединяется сразу после переноса его элемента, поэтому при
+     * исключении в присваивании очередь остается согласованной.
+     * @param out Итератор вывода, в который перемещаются элементы.
+     * @param n Максимальное количество элементов.
+     * @return Количество извлеченных элементов.
+     */
+    template<typename OutputIt>
+    int dequeue_n(OutputIt out, int n) {
+        int taken = 0;
+        for (; taken < n && !isEmpty(); ++taken) {
+            *out = std::move(start_element->data);
+            ++out;
+            dequeue();
+        }
+        return taken;
+    }
+
     /**
      * @brief Вывод всех элементов очереди.
      * 
@@ -156,43 +277,1784 @@ public:
     Iterator end() const {
         return Iterator(nullptr);
     }
+
+    /**
+     * @brief Присоединение готового элемента к концу очереди.
+     */
+    void link(Element* newElement) {
+        if (isEmpty()) {
+            start_element = end_element = newElement;
+        } else {
+            end_element->next = newElement;
+            end_element = newElement;
+        }
+        ++size;
+    }
 };
 
-int main() {
-    Queue<int> q;
+/**
+ * @brief Очередь на кольцевом буфере.
+ *
+ * Элементы лежат в одном непрерывном массиве, выровненном по кэш-линии. Емкость -
+ * степень двойки, поэтому индекс по кругу вычисляется маской, а не делением. При
+ * заполнении массив увеличивается вдвое, так что выделение памяти происходит
+ * O(log n) раз, а не на каждый элемент. Интерфейс совпадает с Queue.
+ */
+template<typename T>
+class RingQueue {
+public:
+    static const int cacheLine = 64;  // Размер кэш-линии в байтах
 
-    int choice;
-    do {
-        std::cout << "\nSelect operation:\n";
-        std::cout << "1. Get queue size\n";
-        std::cout << "2. Add element to end\n";
-        std::cout << "3. Get element from start\n";
-        std::cout << "4. Remove element from beginning\n";
-        std::cout << "0. Exit\n";
+    T* data;       // Кольцевой буфер.
+    int capacity;  // Емкость (степень двойки).
+    int head;      // Индекс первого элемента.
+    int size;      // Текущий размер очереди.
 
-        std::cin >> choice;
+    RingQueue() : data(nullptr), capacity(0), head(0), size(0) {}
 
-        switch (choice) {
-            case 1:
-                q.printQueue();
-                std::cout << "Queue size: " << q.size << "\n";
-                break;
-            case 2:
-                q.printQueue();
-                std::cout << "Enter value: ";
-                int value;
-                std::cin >> value;
-                q.enqueue(value);
-                std::cout << std::endl;
-                q.printQueue();
-                break;
-            case 3:
-                q.printQueue();
-                std::cout << "Element from start: " << *q.peek() << std::endl;
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    ~RingQueue() {
+        while (!isEmpty()) {
+            dequeue();
+        }
+        release(data);
+    }
+
+    /**
+     * @brief Добавление элемента в конец очереди.
+     * @param value Значение, которое нужно добавить в очередь.
+     */
+    void enqueue(const T& value) {
+        emplace(value);
+    }
+
+    /**
+     * @brief Добавление элемента в конец очереди перемещением.
+     */
+    void enqueue(T&& value) {
+        emplace(std::move(value));
+    }
+
+    /**
+     * @brief Создание элемента прямо в конце очереди.
+     * @return Ссылка на созданный элемент.
+     */
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        if (size == capacity) {
+            return grow(std::forward<Args>(args)...);
+        }
+        T* slot = new (data + ((head + size) & (capacity - 1))) T(std::forward<Args>(args)...);
+        ++size;
+        return *slot;
+    }
+
+    /**
+     * @brief Извлечение элемента из начала очереди перемещением в out.
+     * @return false, если очередь пуста.
+     */
+    bool try_pop(T& out) {
+        if (isEmpty()) {
+            return false;
+        }
+        out = std::move(data[head]);
+        dequeue();
+        return true;
+    }
+
+    /**
+     * @brief Удаление элемента из начала очереди.
+     * @return false, если очередь пуста.
+     */
+    bool dequeue() {
+        if (isEmpty()) {
+            return false;
+        }
+        data[head].~T();
+        head = (head + 1) & (capacity - 1);
+        --size;
+        return true;
+    }
+
+    /**
+     * @brief Добавление диапазона элементов одной операцией.
+     *
+     * При исключении в конструкторе T уже добавленные элементы диапазона
+     * удаляются с конца, и очередь остается прежней.
+     * @param first Начало диапазона.
+     * @param last Конец диапазона.
+     */
+    template<typename InputIt>
+    void enqueue_range(InputIt first, InputIt last) {
+        int oldSize = size;
+        try {
+            for (; first != last; ++first) {
+                emplace(*first);
+            }
+        } catch (...) {
+            while (size > oldSize) {
+                --size;
+                data[(head + size) & (capacity - 1)].~T();
+            }
+            throw;
+        }
+    }
+
+    /**
+     * @brief Извлечение до n элементов из начала очереди.
+     * @param out Итератор вывода, в который перемещаются элементы.
+     * @param n Максимальное количество элементов.
+     * @return Количество извлеченных элементов.
+     */
+    template<typename OutputIt>
+    int dequeue_n(OutputIt out, int n) {
+        int taken = 0;
+        for (; taken < n && !isEmpty(); ++taken) {
+            *out = std::move(data[head]);
+            ++out;
+            dequeue();
+        }
+        return taken;
+    }
+
+    /**
+     * @brief Получение элемента из начала очереди без его удаления.
+     * @return Указатель на данные элемента в начале очереди.
+     * Возвращает nullptr, если очередь пуста.
+     */
+    T* peek() const {
+        if (isEmpty()) {
+            return nullptr;
+        }
+        return &data[head];
+    }
+
+    /**
+     * @brief Вывод всех элементов очереди.
+     */
+    void printQueue() const {
+        if (isEmpty()) {
+            std::cout << "Queue is empty!" << std::endl;
+            return;
+        }
+        std::cout << "Queue elements: ";
+        for (auto el : *this) {
+            std::cout << el << " ";
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Проверка, пуста ли очередь.
+     * @return true, если очередь пуста, иначе false.
+     */
+    bool isEmpty() const {
+        return size == 0;
+    }
+
+    /**
+     * @brief Получение текущего размера очереди.
+     * @return Количество элементов в очереди.
+     */
+    int getSize() const {
+        return size;
+    }
+
+    /**
+     * @brief Класс итератора: номер элемента от начала очереди.
+     */
+    class Iterator {
+    public:
+        const RingQueue* queue;
+        int position;
+
+        Iterator(const RingQueue* queue, int position) : queue(queue), position(position) {}
+
+        bool operator!=(const Iterator& other) const {
+            return position != other.position;
+        }
+
+        Iterator& operator++() {
+            ++position;
+            return *this;
+        }
+
+        T& operator*() const {
+            return queue->data[(queue->head + position) & (queue->capacity - 1)];
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() const {
+        return Iterator(this, size);
+    }
+
+    static T* allocate(int count) {
+        return static_cast<T*>(::operator new(sizeof(T) * count, std::align_val_t(cacheLine)));
+    }
+
+    static void release(T* buffer) {
+        if (buffer) {
+            ::operator delete(buffer, std::align_val_t(cacheLine));
+        }
+    }
+
+    /**
+     * @brief Увеличение емкости вдвое с переносом элементов в начало нового буфера
+     * и созданием нового элемента в его конце.
+     *
+     * Новый элемент создается до переноса старых, так как аргумент может ссылаться
+     * на элемент самой очереди (q.enqueue(q.front())).
+     * @return Ссылка на созданный элемент.
+     */
+    template<typename... Args>
+    T& grow(Args&&... args) {
+        int newCapacity = capacity ? capacity * 2 : 16;
+        T* newData = allocate(newCapacity);
+        T* slot;
+        try {
+            slot = new (newData + size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            release(newData);
+            throw;
+        }
+        for (int i = 0; i < size; ++i) {
+            T* old = data + ((head + i) & (capacity - 1));
+            new (newData + i) T(std::move(*old));
+            old->~T();
+        }
+        release(data);
+        data = newData;
+        capacity = newCapacity;
+        head = 0;
+        ++size;
+        return *slot;
+    }
+};
+
+/**
+ * @brief Очередь на развернутом списке: каждый узел хранит блок из BlockSize элементов.
+ *
+ * Память выделяется раз на BlockSize элементов, а опустевшие блоки уходят в список
+ * свободных и переиспользуются. В установившемся режиме (сколько добавили, столько
+ * и забрали) аллокатор не вызывается вовсе. Интерфейс совпадает с Queue.
+ */
+template<typename T, int BlockSize = 64>
+class BlockQueue {
+public:
+    struct Block {
+        alignas(T) unsigned char storage[sizeof(T) * BlockSize];  // Место под элементы.
+        Block* next;  // Следующий блок очереди или списка свободных.
+
+        T* items() {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
+
+    Block* head_block;  // Блок с первым элементом.
+    Block* tail_block;  // Блок, в который добавляются элементы.
+    Block* free_blocks; // Список опустевших блоков для повторного использования.
+    int head_index;     // Позиция первого элемента в head_block.
+    int tail_index;     // Позиция для следующего элемента в tail_block.
+    int size;           // Текущий размер очереди.
+
+    BlockQueue() : head_block(nullptr), tail_block(nullptr), free_blocks(nullptr),
+                   head_index(0), tail_index(0), size(0) {}
+
+    BlockQueue(const BlockQueue&) = delete;
+    BlockQueue& operator=(const BlockQueue&) = delete;
+
+    ~BlockQueue() {
+        while (!isEmpty()) {
+            dequeue();
+        }
+        delete head_block;
+        while (free_blocks) {
+            Block* temp = free_blocks;
+            free_blocks = free_blocks->next;
+            delete temp;
+        }
+    }
+
+    /**
+     * @brief Добавление элемента в конец очереди.
+     * @param value Значение, которое нужно добавить в очередь.
+     */
+    void enqueue(const T& value) {
+        emplace(value);
+    }
+
+    /**
+     * @brief Добавление элемента в конец очереди перемещением.
+     */
+    void enqueue(T&& value) {
+        emplace(std::move(value));
+    }
+
+    /**
+     * @brief Создание элемента прямо в конце очереди.
+     * @return Ссылка на созданный элемент.
+     */
+    template<typename... Args>
+    T& emplace(Args&&... args) {
+        if (!tail_block) {
+            head_block = tail_block = takeBlock();
+        } else if (tail_index == BlockSize) {
+            tail_block->next = takeBlock();
+            tail_block = tail_block->next;
+            tail_index = 0;
+        }
+        T* slot = new (tail_block->items() + tail_index) T(std::forward<Args>(args)...);
+        ++tail_index;
+        ++size;
+        return *slot;
+    }
+
+    /**
+     * @brief Извлечение элемента из начала очереди перемещением в out.
+     * @return false, если очередь пуста.
+     */
+    bool try_pop(T& out) {
+        if (isEmpty()) {
+            return false;
+        }
+        out = std::move(head_block->items()[head_index]);
+        dequeue();
+        return true;
+    }
+
+    /**
+     * @brief Удаление элемента из начала очереди.
+     *
+     * Опустевший блок переносится в список свободных.
+     * @return false, если очередь пуста.
+     */
+    bool dequeue() {
+        if (isEmpty()) {
+            return false;
+        }
+        head_block->items()[head_index].~T();
+        ++head_index;
+        --size;
+        if (isEmpty()) {
+            // Единственный блок остается на месте, заполнение начинается с его начала
+            head_index = tail_index = 0;
+        } else if (head_index == BlockSize) {
+            Block* temp = head_block;
+            head_block = head_block->next;
+            head_index = 0;
+            temp->next = free_blocks;
+            free_blocks = temp;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Добавление диапазона элементов одной операцией.
+     *
+     * При исключении в конструкторе T уже добавленные элементы диапазона
+     * удаляются, их блоки возвращаются в список свободных, и очередь остается прежней.
+     * @param first Начало диапазона.
+     * @param last Конец диапазона.
+     */
+    template<typename InputIt>
+    void enqueue_range(InputIt first, InputIt last) {
+        Block* oldTail = tail_block;
+        int oldIndex = tail_index;
+        int oldSize = size;
+        try {
+            for (; first != last; ++first) {
+                emplace(*first);
+            }
+        } catch (...) {
+            // Элементы диапазона идут от (oldTail, oldIndex), а при пустой очереди - от начала
+            Block* block = oldTail ? oldTail : head_block;
+            int index = oldTail ? oldIndex : 0;
+            for (int i = oldSize; i < size; ++i) {
+                if (index == BlockSize) {
+                    block = block->next;
+                    index = 0;
+                }
+                block->items()[index++].~T();
+            }
+            Block* spare = oldTail ? oldTail->next : head_block;
+            while (spare) {
+                Block* temp = spare;
+                spare = spare->next;
+                temp->next = free_blocks;
+                free_blocks = temp;
+            }
+            if (oldTail) {
+                oldTail->next = nullptr;
+            } else {
+                head_block = nullptr;
+                head_index = 0;
+            }
+            tail_block = oldTail;
+            tail_index = oldIndex;
+            size = oldSize;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Извлечение до n элементов из начала очереди.
+     * @param out Итератор вывода, в который перемещаются элементы.
+     * @param n Максимальное количество элементов.
+     * @return Количество извлеченных элементов.
+     */
+    template<typename OutputIt>
+    int dequeue_n(OutputIt out, int n) {
+        int taken = 0;
+        for (; taken < n && !isEmpty(); ++taken) {
+            *out = std::move(head_block->items()[head_index]);
+            ++out;
+            dequeue();
+        }
+        return taken;
+    }
+
+    /**
+     * @brief Получение элемента из начала очереди без его удаления.
+     * @return Указатель на данные элемента в начале очереди.
+     * Возвращает nullptr, если очередь пуста.
+     */
+    T* peek() const {
+        if (isEmpty()) {
+            return nullptr;
+        }
+        return head_block->items() + head_index;
+    }
+
+    /**
+     * @brief Вывод всех элементов очереди.
+     */
+    void printQueue() const {
+        if (isEmpty()) {
+            std::cout << "Queue is empty!" << std::endl;
+            return;
+        }
+        std::cout << "Queue elements: ";
+        for (auto el : *this) {
+            std::cout << el << " ";
+        }
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Проверка, пуста ли очередь.
+     * @return true, если очередь пуста, иначе false.
+     */
+    bool isEmpty() const {
+        return size == 0;
+    }
+
+    /**
+     * @brief Получение текущего размера очереди.
+     * @return Количество элементов в очереди.
+     */
+    int getSize() const {
+        return size;
+    }
+
+    /**
+     * @brief Класс итератора: идет подряд по элементам блока, затем переходит к следующему.
+     */
+    class Iterator {
+    public:
+        Block* block;  ///< Текущий блок.
+        int index;     ///< Позиция внутри блока.
+
+        Iterator(Block* block, int index) : block(block), index(index) {}
+
+        bool operator!=(const Iterator& other) const {
+            return block != other.block || index != other.index;
+        }
+
+        Iterator& operator++() {
+            if (++index == BlockSize) {
+                block = block->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        T& operator*() const {
+            return block->items()[index];
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(head_block, head_index);
+    }
+
+    Iterator end() const {
+        // Последний блок всегда замыкает цепочку (next == nullptr)
+        if (tail_index == BlockSize) {
+            return Iterator(nullptr, 0);
+        }
+        return Iterator(tail_block, tail_index);
+    }
+
+    /**
+     * @brief Блок из списка свободных или новый, если список пуст.
+     */
+    Block* takeBlock() {
+        Block* block = free_blocks;
+        if (block) {
+            free_blocks = block->next;
+        } else {
+            block = new Block;
+        }
+        block->next = nullptr;
+        return block;
+    }
+};
+
+/**
+ * @brief Ближайшая степень двойки, не меньшая value (минимум 2).
+ */
+inline size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+/**
+ * @brief Ограниченная очередь без блокировок для одного производителя и одного потребителя.
+ *
+ * Производитель пишет только tail, потребитель - только head, поэтому хватает
+ * атомарных load/store без CAS. Каждая сторона держит кэшированную копию чужого
+ * индекса и перечитывает ее лишь тогда, когда очередь по кэшу выглядит полной
+ * (пустой). Индексы разнесены по разным кэш-линиям, чтобы потоки не делили линию.
+ */
+template<typename T>
+class SpscQueue {
+public:
+    static const int cacheLine = 64;  // Размер кэш-линии в байтах
+
+    alignas(cacheLine) std::atomic<size_t> head;  // Следующая позиция для чтения (пишет потребитель).
+    size_t cached_tail;                           // Последний увиденный потребителем tail.
+    alignas(cacheLine) std::atomic<size_t> tail;  // Следующая позиция для записи (пишет производитель).
+    size_t cached_head;                           // Последний увиденный производителем head.
+    alignas(cacheLine) T* data;                   // Кольцевой буфер.
+    size_t mask;                                  // Емкость минус один.
+
+    explicit SpscQueue(size_t capacity)
+        : head(0), cached_tail(0), tail(0), cached_head(0), mask(roundUpToPowerOfTwo(capacity) - 1) {
+        data = static_cast<T*>(::operator new(sizeof(T) * (mask + 1), std::align_val_t(cacheLine)));
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        for (size_t i = head.load(); i != tail.load(); ++i) {
+            data[i & mask].~T();
+        }
+        ::operator delete(data, std::align_val_t(cacheLine));
+    }
+
+    /**
+     * @brief Попытка добавить элемент (вызывается только производителем).
+     * @return false, если очередь заполнена.
+     */
+    bool try_enqueue(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head > mask) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head > mask) {
+                return false;
+            }
+        }
+        new (data + (t & mask)) T(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Попытка извлечь элемент (вызывается только потребителем).
+     * @return false, если очередь пуста.
+     */
+    bool try_dequeue(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail) {
+                return false;
+            }
+        }
+        T* item = data + (h & mask);
+        out = std::move(*item);
+        item->~T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * @brief Ограниченная очередь без блокировок для многих производителей и потребителей (схема Вьюкова).
+ *
+ * У каждой ячейки есть номер последовательности: он говорит, чья сейчас очередь
+ * работать с ячейкой - производителя с позицией pos (sequence == pos) или
+ * потребителя (sequence == pos + 1). Поток занимает позицию одним CAS по общему
+ * счетчику, а данные публикует записью sequence с release.
+ */
+template<typename T>
+class MpmcQueue {
+public:
+    static const int cacheLine = 64;  // Размер кэш-линии в байтах
+
+    struct Cell {
+        std::atomic<size_t> sequence;          // Номер последовательности ячейки.
+        alignas(T) unsigned char storage[sizeof(T)];  // Место под элемент.
+
+        T* item() {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
+
+    alignas(cacheLine) Cell* cells;                       // Кольцевой буфер ячеек.
+    size_t mask;                                          // Емкость минус один.
+    alignas(cacheLine) std::atomic<size_t> enqueue_pos;   // Счетчик производителей.
+    alignas(cacheLine) std::atomic<size_t> dequeue_pos;   // Счетчик потребителей.
+
+    explicit MpmcQueue(size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1), enqueue_pos(0), dequeue_pos(0) {
+        cells = static_cast<Cell*>(::operator new(sizeof(Cell) * (mask + 1), std::align_val_t(cacheLine)));
+        for (size_t i = 0; i <= mask; ++i) {
+            new (&cells[i].sequence) std::atomic<size_t>(i);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    ~MpmcQueue() {
+        for (size_t pos = dequeue_pos.load(); pos != enqueue_pos.load(); ++pos) {
+            cells[pos & mask].item()->~T();
+        }
+        ::operator delete(cells, std::align_val_t(cacheLine));
+    }
+
+    /**
+     * @brief Попытка добавить элемент.
+     * @return false, если очередь заполнена.
+     */
+    bool try_enqueue(const T& value) {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->item()) T(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Попытка извлечь элемент.
+     * @return false, если очередь пуста.
+     */
+    bool try_dequeue(T& out) {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(*cell->item());
+        cell->item()->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * @brief Ограниченная блокирующая очередь для конвейеров производитель-потребитель.
+ *
+ * Производитель ждет, пока в заполненной очереди освободится место, потребитель -
+ * пока в пустой появятся элементы. Перед сном поток немного крутится, проверяя
+ * атомарный размер без мьютекса: при частом обмене это избавляет от системных вызовов.
+ * Длина кручения подстраивается: она держится около удвоенного среднего числа проверок,
+ * которых хватало раньше, и сокращается, если поток все равно засыпал.
+ * Потом он засыпает на condition_variable (в Linux это futex). Будят по одному потоку
+ * на каждый добавленный или извлеченный элемент и только при наличии ждущих, а не
+ * всех сразу. После close() новые элементы не принимаются, оставшиеся можно дочитать.
+ */
+template<typename T>
+class BlockingQueue {
+public:
+    static const int cacheLine = 64;  // Размер кэш-линии в байтах
+    static const int spinLimit = 64;  // Наибольшее число проверок перед сном
+
+    T* data;                       // Кольцевой буфер.
+    int capacity;                  // Емкость.
+    int head;                      // Индекс первого элемента.
+    std::atomic<int> size;         // Текущий размер (меняется под мьютексом, читается при ожидании).
+    std::atomic<bool> closed;      // Очередь закрыта для добавления.
+    std::atomic<int> spins;        // Скользящее среднее проверок до успеха при кручении.
+    int waiting_producers;         // Производители, спящие на not_full.
+    int waiting_consumers;         // Потребители, спящие на not_empty.
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+
+    explicit BlockingQueue(int capacity)
+        : capacity(capacity), head(0), size(0), closed(false), spins(spinLimit / 4), waiting_producers(0),
+          waiting_consumers(0) {
+        if (capacity < 1) {
+            throw std::invalid_argument("BlockingQueue capacity must be positive");
+        }
+        data = static_cast<T*>(::operator new(sizeof(T) * capacity, std::align_val_t(cacheLine)));
+    }
+
+    BlockingQueue(const BlockingQueue&) = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    ~BlockingQueue() {
+        for (int i = 0; i < size; ++i) {
+            data[(head + i) % capacity].~T();
+        }
+        ::operator delete(data, std::align_val_t(cacheLine));
+    }
+
+    /**
+     * @brief Добавление элемента; ждет, пока появится место.
+     * @return false, если очередь закрыта.
+     */
+    bool push(T value) {
+        return pushUntil(std::move(value), nullptr);
+    }
+
+    /**
+     * @brief Добавление элемента с ограничением времени ожидания.
+     * @return false, если очередь закрыта или время вышло.
+     */
+    template<typename Rep, typename Period>
+    bool push_for(T value, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return pushUntil(std::move(value), &deadline);
+    }
+
+    /**
+     * @brief Извлечение элемента; ждет, пока он появится.
+     * @return false, если очередь закрыта и пуста.
+     */
+    bool pop(T& out) {
+        return popUntil(&out, 1, nullptr) == 1;
+    }
+
+    /**
+     * @brief Извлечение элемента с ограничением времени ожидания.
+     * @return false, если очередь закрыта и пуста или время вышло.
+     */
+    template<typename Rep, typename Period>
+    bool pop_for(T& out, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return popUntil(&out, 1, &deadline) == 1;
+    }
+
+    /**
+     * @brief Извлечение от одного до n элементов за один захват мьютекса.
+     * @return Количество извлеченных элементов; 0 - очередь закрыта и пуста.
+     */
+    int pop_n(T* out, int n) {
+        return popUntil(out, n, nullptr);
+    }
+
+    /**
+     * @brief Закрытие очереди: будит всех ждущих, новые элементы не принимаются.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    /**
+     * @brief Получение текущего размера очереди.
+     */
+    int getSize() const {
+        return size.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Короткое ожидание без сна, пока ready() ложно.
+     *
+     * Проверок не больше удвоенного среднего плюс запас. Успех после i проверок сдвигает
+     * среднее к i, неудача - к нулю, как у адаптивного мьютекса glibc.
+     */
+    template<typename Ready>
+    void spin(Ready ready) {
+        int average = spins.load(std::memory_order_relaxed);
+        int limit = std::min(spinLimit, 2 * average + 4);
+        int i = 0;
+        while (!ready()) {
+            if (++i > limit) {
+                spins.store(average - average / 8, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        if (i > 0) {
+            spins.store(average + (i - average) / 8, std::memory_order_relaxed);
+        }
+    }
+
+    bool pushUntil(T&& value, const std::chrono::steady_clock::time_point* deadline) {
+        spin([this]() { return size.load(std::memory_order_relaxed) < capacity || closed; });
+        std::unique_lock<std::mutex> lock(mutex);
+        while (size == capacity && !closed) {
+            ++waiting_producers;
+            bool timedOut = false;
+            if (deadline) {
+                timedOut = not_full.wait_until(lock, *deadline) == std::cv_status::timeout;
+            } else {
+                not_full.wait(lock);
+            }
+            --waiting_producers;
+            if (timedOut && size == capacity) {
+                return false;
+            }
+        }
+        if (closed) {
+            return false;
+        }
+        new (data + (head + size) % capacity) T(std::move(value));
+        size.store(size + 1, std::memory_order_relaxed);
+        bool wake = waiting_consumers > 0;
+        lock.unlock();
+        if (wake) {
+            not_empty.notify_one();
+        }
+        return true;
+    }
+
+    int popUntil(T* out, int n, const std::chrono::steady_clock::time_point* deadline) {
+        spin([this]() { return size.load(std::memory_order_relaxed) > 0 || closed; });
+        std::unique_lock<std::mutex> lock(mutex);
+        while (size == 0 && !closed) {
+            ++waiting_consumers;
+            bool timedOut = false;
+            if (deadline) {
+                timedOut = not_empty.wait_until(lock, *deadline) == std::cv_status::timeout;
+            } else {
+                not_empty.wait(lock);
+            }
+            --waiting_consumers;
+            if (timedOut && size == 0) {
+                return 0;
+            }
+        }
+        int taken = std::min(n, size.load(std::memory_order_relaxed));
+        for (int i = 0; i < taken; ++i) {
+            out[i] = std::move(data[head]);
+            data[head].~T();
+            head = (head + 1) % capacity;
+        }
+        size.store(size - taken, std::memory_order_relaxed);
+        int wake = std::min(taken, waiting_producers);
+        lock.unlock();
+        // Будим не больше производителей, чем освободилось мест
+        for (int i = 0; i < wake; ++i) {
+            not_full.notify_one();
+        }
+        return taken;
+    }
+};
+
+/**
+ * @brief Дек с кражей работы (Chase-Lev) для планировщика задач.
+ *
+ * Владелец кладет и забирает задачи с нижнего конца без блокировок, другие потоки
+ * крадут с верхнего одним CAS. Единственная гонка - за последний элемент - решается
+ * тем же CAS по top. Массив растет вдвое; старые массивы не освобождаются до
+ * уничтожения дека, потому что вор может еще читать из них. T должен быть
+ * тривиально копируемым (индекс или указатель на задачу).
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    static const int cacheLine = 64;  // Размер кэш-линии в байтах
+
+    struct Array {
+        long long capacity;        // Емкость (степень двойки).
+        std::atomic<T>* items;     // Элементы.
+        Array* retired;            // Предыдущий (меньший) массив.
+
+        Array(long long capacity, Array* retired) : capacity(capacity), retired(retired) {
+            items = static_cast<std::atomic<T>*>(::operator new(sizeof(std::atomic<T>) * capacity));
+            for (long long i = 0; i < capacity; ++i) {
+                new (items + i) std::atomic<T>(T());
+            }
+        }
+
+        ~Array() {
+            ::operator delete(items);
+        }
+
+        T get(long long index) const {
+            return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(long long index, T value) {
+            items[index & (capacity - 1)].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(cacheLine) std::atomic<long long> top;     // Верх: отсюда крадут.
+    alignas(cacheLine) std::atomic<long long> bottom;  // Низ: здесь работает владелец.
+    alignas(cacheLine) std::atomic<Array*> array;      // Текущий массив.
+
+    explicit WorkStealingDeque(long long capacity = 64)
+        : top(0), bottom(0), array(new Array((long long)roundUpToPowerOfTwo(capacity), nullptr)) {}
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    ~WorkStealingDeque() {
+        Array* a = array.load();
+        while (a) {
+            Array* temp = a;
+            a = a->retired;
+            delete temp;
+        }
+    }
+
+    /**
+     * @brief Добавление задачи снизу (только владелец).
+     */
+    void push(T value) {
+        long long b = bottom.load(std::memory_order_relaxed);
+        long long t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Извлечение задачи снизу (только владелец), в порядке LIFO.
+     * @return false, если дек пуст или последнюю задачу забрал вор.
+     */
+    bool pop(T& out) {
+        long long b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t == b) {
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Кража задачи сверху (любой поток), в порядке FIFO.
+     * @return false, если дек пуст или кражу перехватил другой поток.
+     */
+    bool steal(T& out) {
+        long long t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array.load(std::memory_order_acquire);
+        out = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Оценка размера (точна, только когда дек никто не меняет).
+     */
+    int getSize() const {
+        long long size = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+        return size > 0 ? (int)size : 0;
+    }
+
+    bool isEmpty() const {
+        return getSize() == 0;
+    }
+
+    /**
+     * @brief Итератор от верха к низу; обходить дек можно, только пока его никто не меняет.
+     */
+    class Iterator {
+    public:
+        const Array* items;  ///< Массив элементов.
+        long long index;     ///< Логический индекс элемента.
+
+        Iterator(const Array* items, long long index) : items(items), index(index) {}
+
+        bool operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+
+        Iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        T operator*() const {
+            return items->get(index);
+        }
+    };
+
+    Iterator begin() const {
+        return Iterator(array.load(), top.load());
+    }
+
+    Iterator end() const {
+        return Iterator(array.load(), std::max(top.load(), bottom.load()));
+    }
+
+    /**
+     * @brief Перенос элементов [t, b) в массив вдвое большей емкости.
+     */
+    Array* grow(Array* a, long long t, long long b) {
+        Array* bigger = new Array(a->capacity * 2, a);
+        for (long long i = t; i < b; ++i) {
+            bigger->put(i, a->get(i));
+        }
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+/**
+ * @brief Очередь с приоритетом на d-арной куче.
+ *
+ * По аналогии с std::priority_queue сверху лежит наибольший по Compare элемент.
+ * У узла D потомков, поэтому куча ниже двоичной в log2(D) раз: вставка делает меньше
+ * сравнений, а при извлечении потомки одного узла лежат рядом в памяти.
+ */
+template<typename T, int D = 4, typename Compare = std::less<T>>
+class DaryHeap {
+public:
+    T* data;       // Элементы в порядке кучи.
+    int capacity;  // Емкость массива.
+    int size;      // Текущий размер кучи.
+    Compare less;  // Сравнение приоритетов.
+
+    DaryHeap() : data(nullptr), capacity(0), size(0) {}
+
+    DaryHeap(const DaryHeap&) = delete;
+    DaryHeap& operator=(const DaryHeap&) = delete;
+
+    ~DaryHeap() {
+        for (int i = 0; i < size; ++i) {
+            data[i].~T();
+        }
+        ::operator delete(data);
+    }
+
+    /**
+     * @brief Добавление элемента.
+     */
+    void push(const T& value) {
+        emplace(value);
+    }
+
+    void push(T&& value) {
+        emplace(std::move(value));
+    }
+
+    /**
+     * @brief Создание элемента на месте и подъем его к своему уровню.
+     */
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        if (size == capacity) {
+            grow();
+        }
+        T value(std::forward<Args>(args)...);
+        int i = size;
+        new (data + size) T(std::move(value));
+        ++size;
+        while (i > 0) {
+            int parent = (i - 1) / D;
+            if (!less(data[parent], data[i])) {
+                break;
+            }
+            std::swap(data[parent], data[i]);
+            i = parent;
+        }
+    }
+
+    /**
+     * @brief Элемент с наибольшим приоритетом.
+     * @return nullptr, если куча пуста.
+     */
+    T* top() const {
+        return size ? data : nullptr;
+    }
+
+    /**
+     * @brief Извлечение элемента с наибольшим приоритетом перемещением в out.
+     * @return false, если куча пуста.
+     */
+    bool try_pop(T& out) {
+        if (size == 0) {
+            return false;
+        }
+        out = std::move(data[0]);
+        --size;
+        if (size > 0) {
+            data[0] = std::move(data[size]);
+            siftDown(0);
+        }
+        data[size].~T();
+        return true;
+    }
+
+    bool isEmpty() const {
+        return size == 0;
+    }
+
+    int getSize() const {
+        return size;
+    }
+
+    /**
+     * @brief Обход элементов в порядке хранения (не по приоритету).
+     */
+    T* begin() const {
+        return data;
+    }
+
+    T* end() const {
+        return data + size;
+    }
+
+    void siftDown(int i) {
+        for (;;) {
+            int first = i * D + 1;
+            if (first >= size) {
+                break;
+            }
+            int best = first;
+            int last = std::min(first + D, size);
+            for (int c = first + 1; c < last; ++c) {
+                if (less(data[best], data[c])) {
+                    best = c;
+                }
+            }
+            if (!less(data[i], data[best])) {
+                break;
+            }
+            std::swap(data[i], data[best]);
+            i = best;
+        }
+    }
+
+    void grow() {
+        int newCapacity = capacity ? capacity * 2 : 16;
+        T* newData = static_cast<T*>(::operator new(sizeof(T) * newCapacity));
+        for (int i = 0; i < size; ++i) {
+            new (newData + i) T(std::move(data[i]));
+            data[i].~T();
+        }
+        ::operator delete(data);
+        data = newData;
+        capacity = newCapacity;
+    }
+};
+
+/**
+ * @brief Замер конкурентной очереди: производители кладут метки времени, потребители
+ * считают задержку от добавления до извлечения.
+ * @tparam Q Очередь с try_enqueue/try_dequeue для uint64_t.
+ * @param title Название реализации.
+ * @param producers Количество потоков-производителей.
+ * @param consumers Количество потоков-потребителей.
+ * @param count Общее количество элементов.
+ */
+template<typename Q>
+void benchmarkConcurrent(const std::string& title, int producers, int consumers, long long count) {
+    using Clock = std::chrono::steady_clock;
+    const uint64_t stop = UINT64_MAX;  // Сигнал потребителю завершиться
+    auto now = []() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+    };
+
+    struct Latency {
+        alignas(64) double sum = 0;
+        double max = 0;
+        long long items = 0;
+    };
+
+    Q q(1024);
+    std::vector<Latency> latency(consumers);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            Latency& own = latency[c];
+            uint64_t stamp;
+            for (;;) {
+                if (!q.try_dequeue(stamp)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (stamp == stop) {
+                    break;
+                }
+                double wait = (double)(now() - stamp);
+                own.sum += wait;
+                own.max = std::max(own.max, wait);
+                ++own.items;
+            }
+        });
+    }
+    std::vector<std::thread> producerThreads;
+    for (int p = 0; p < producers; ++p) {
+        producerThreads.emplace_back([&, p]() {
+            long long share = count / producers + (p < count % producers ? 1 : 0);
+            for (long long i = 0; i < share; ++i) {
+                while (!q.try_enqueue(now())) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : producerThreads) {
+        t.join();
+    }
+    for (int c = 0; c < consumers; ++c) {
+        while (!q.try_enqueue(stop)) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double sum = 0, max = 0;
+    long long items = 0;
+    for (const Latency& l : latency) {
+        sum += l.sum;
+        max = std::max(max, l.max);
+        items += l.items;
+    }
+    std::cout << title << " " << producers << "P/" << consumers << "C: "
+              << items / seconds / 1e6 << " M items/s, latency avg " << sum / items / 1000
+              << " us, max " << max / 1000 << " us\n";
+}
+
+/**
+ * @brief Замер одной реализации очереди: заполнение, обход, чередование и опустошение.
+ * @tparam Q Тип очереди с интерфейсом Queue.
+ * @param title Название реализации.
+ * @param count Количество элементов.
+ */
+template<typename Q>
+void benchmarkQueue(const std::string& title, int count) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    Q q;
+    auto t0 = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        q.enqueue(i);
+    }
+    auto t1 = Clock::now();
+    long long sum = 0;
+    for (auto el : q) {
+        sum += el;
+    }
+    auto t2 = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        q.enqueue(i);
+        q.dequeue();
+    }
+    auto t3 = Clock::now();
+    while (!q.isEmpty()) {
+        q.dequeue();
+    }
+    auto t4 = Clock::now();
+
+    std::cout << title << ": enqueue " << ms(t0, t1) << " ms, iterate " << ms(t1, t2)
+              << " ms, enqueue+dequeue " << ms(t2, t3) << " ms, dequeue " << ms(t3, t4)
+              << " ms (checksum " << sum << ")\n";
+}
+
+/**
+ * @brief Замер передачи тяжелых элементов (строк) через Queue: копирование против перемещения.
+ * @param count Количество строк.
+ */
+void benchmarkMoves(int count) {
+    using Clock = std::chrono::steady_clock;
+    const std::string pattern(256, 'x');
+
+    Queue<std::string> q;
+    auto t0 = Clock::now();
+    long long copied = 0;
+    for (int i = 0; i < count; ++i) {
+        std::string value = pattern;
+        q.enqueue(value);
+        copied += q.peek()->size();
+        q.dequeue();
+    }
+    auto t1 = Clock::now();
+    long long moved = 0;
+    std::string out;
+    for (int i = 0; i < count; ++i) {
+        std::string value = pattern;
+        q.enqueue(std::move(value));
+        q.try_pop(out);
+        moved += out.size();
+    }
+    auto t2 = Clock::now();
+    std::cout << "Strings: copy " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms, move " << std::chrono::duration<double, std::milli>(t2 - t1).count()
+              << " ms (" << copied << " / " << moved << " bytes)\n";
+}
+
+/**
+ * @brief Сравнение блокирующей очереди с опросом SpscQueue в цикле.
+ *
+ * Пинг-понг между двумя потоками дает задержку передачи туда и обратно, потоковая
+ * передача - пропускную способность. Процессорное время показывает, сколько ядер
+ * сжигается на ожидание.
+ * @param count Количество элементов.
+ */
+void benchmarkBlocking(int count) {
+    using Clock = std::chrono::steady_clock;
+    auto report = [count](const std::string& title, Clock::time_point start, std::clock_t cpuStart) {
+        double wall = std::chrono::duration<double>(Clock::now() - start).count();
+        double cpu = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        std::cout << title << ": " << wall * 1e6 / count << " us per item, "
+                  << count / wall / 1e6 << " M items/s, CPU " << cpu << " s of " << wall << " s wall\n";
+    };
+
+    {
+        BlockingQueue<int> ping(1), pong(1);
+        auto start = Clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::thread echo([&]() {
+            int value;
+            while (ping.pop(value)) {
+                pong.push(value);
+            }
+        });
+        int value;
+        for (int i = 0; i < count; ++i) {
+            ping.push(i);
+            pong.pop(value);
+        }
+        ping.close();
+        echo.join();
+        report("Blocking ping-pong", start, cpuStart);
+    }
+    {
+        SpscQueue<int> ping(2), pong(2);
+        auto start = Clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::thread echo([&]() {
+            int value;
+            for (int i = 0; i < count; ++i) {
+                while (!ping.try_dequeue(value)) {
+                    std::this_thread::yield();
+                }
+                while (!pong.try_enqueue(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        int value;
+        for (int i = 0; i < count; ++i) {
+            while (!ping.try_enqueue(i)) {
+                std::this_thread::yield();
+            }
+            while (!pong.try_dequeue(value)) {
+                std::this_thread::yield();
+            }
+        }
+        echo.join();
+        report("Spinning ping-pong", start, cpuStart);
+    }
+    {
+        BlockingQueue<int> q(1024);
+        auto start = Clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::thread consumer([&]() {
+            int batch[64];
+            long long sum = 0;
+            while (int taken = q.pop_n(batch, 64)) {
+                for (int i = 0; i < taken; ++i) {
+                    sum += batch[i];
+                }
+            }
+        });
+        for (int i = 0; i < count; ++i) {
+            q.push(i);
+        }
+        q.close();
+        consumer.join();
+        report("Blocking stream", start, cpuStart);
+    }
+    {
+        SpscQueue<int> q(1024);
+        auto start = Clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::thread consumer([&]() {
+            int value;
+            for (int i = 0; i < count; ++i) {
+                while (!q.try_dequeue(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (int i = 0; i < count; ++i) {
+            while (!q.try_enqueue(i)) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        report("Spinning stream", start, cpuStart);
+    }
+
+    // Редкий производитель: видно, сколько процессора съедает ожидающий потребитель
+    const int ticks = 200;
+    auto idle = [ticks](const std::string& title, auto& q, auto take, auto put) {
+        auto start = Clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::thread consumer([&]() {
+            for (int i = 0; i < ticks; ++i) {
+                take(q);
+            }
+        });
+        for (int i = 0; i < ticks; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            put(q, i);
+        }
+        consumer.join();
+        double wall = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << title << ": CPU " << double(std::clock() - cpuStart) / CLOCKS_PER_SEC
+                  << " s of " << wall << " s wall\n";
+    };
+    BlockingQueue<int> blocking(16);
+    idle("Blocking idle consumer", blocking,
+         [](BlockingQueue<int>& q) { int value; q.pop(value); },
+         [](BlockingQueue<int>& q, int value) { q.push(value); });
+    SpscQueue<int> spinning(16);
+    idle("Spinning idle consumer", spinning,
+         [](SpscQueue<int>& q) { int value; while (!q.try_dequeue(value)) { std::this_thread::yield(); } },
+         [](SpscQueue<int>& q, int value) { q.try_enqueue(value); });
+}
+
+/**
+ * @brief Fork-join задача: полное двоичное дерево, листья выполняют работу,
+ * узел завершается, когда завершены оба потомка.
+ *
+ * Задача - номер узла в нумерации кучи (потомки 2i+1 и 2i+2), поэтому задачи
+ * не нужно выделять, а очереди хранят только int.
+ */
+struct ForkJoinTree {
+    int depth;                     // Глубина дерева.
+    int leafWork;                  // Итераций работы в листе.
+    int firstLeaf;                 // Номер первого листа.
+    std::atomic<int>* pending;     // Незавершенные потомки каждого внутреннего узла.
+    std::atomic<bool> done;        // Корень завершен.
+
+    ForkJoinTree(int depth, int leafWork) : depth(depth), leafWork(leafWork), firstLeaf((1 << depth) - 1), done(false) {
+        pending = static_cast<std::atomic<int>*>(::operator new(sizeof(std::atomic<int>) * firstLeaf));
+        for (int i = 0; i < firstLeaf; ++i) {
+            new (pending + i) std::atomic<int>(2);
+        }
+    }
+
+    ~ForkJoinTree() {
+        ::operator delete(pending);
+    }
+
+    /**
+     * @brief Выполнение задачи: внутренний узел порождает потомков через spawn,
+     * лист считает и сообщает о завершении вверх по дереву.
+     * @return Результат листа (0 для внутреннего узла).
+     */
+    template<typename Spawn>
+    uint64_t run(int node, Spawn spawn) {
+        if (node < firstLeaf) {
+            spawn(2 * node + 2);
+            spawn(2 * node + 1);
+            return 0;
+        }
+        uint64_t x = (uint64_t)node;
+        for (int i = 0; i < leafWork; ++i) {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        // Последний завершившийся потомок завершает родителя
+        while (node > 0) {
+            node = (node - 1) / 2;
+            if (pending[node].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return x >> 60;
+            }
+        }
+        done.store(true, std::memory_order_release);
+        return x >> 60;
+    }
+};
+
+/**
+ * @brief Fork-join на общей FIFO-очереди (Queue под мьютексом).
+ * @return Время в секундах.
+ */
+double runFifoScheduler(int threads, int depth, int leafWork, uint64_t& checksum) {
+    ForkJoinTree tree(depth, leafWork);
+    Queue<int> tasks;
+    std::mutex mutex;
+    std::atomic<uint64_t> total(0);
+    tasks.enqueue(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threads; ++w) {
+        workers.emplace_back([&]() {
+            uint64_t sum = 0;
+            auto spawn = [&](int node) {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.enqueue(node);
+            };
+            while (!tree.done.load(std::memory_order_acquire)) {
+                int node;
+                bool got;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    got = tasks.try_pop(node);
+                }
+                if (got) {
+                    sum += tree.run(node, spawn);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            total += sum;
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    checksum = total;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Fork-join с кражей работы: у каждого потока свой дек, потомки кладутся
+ * в свой дек, при его опустошении поток крадет у случайного соседа.
+ * @return Время в секундах.
+ */
+double runStealingScheduler(int threads, int depth, int leafWork, uint64_t& checksum) {
+    ForkJoinTree tree(depth, leafWork);
+    WorkStealingDeque<int>* deques = static_cast<WorkStealingDeque<int>*>(
+        ::operator new(sizeof(WorkStealingDeque<int>) * threads, std::align_val_t(64)));
+    for (int w = 0; w < threads; ++w) {
+        new (deques + w) WorkStealingDeque<int>(depth * 2 + 2);
+    }
+    deques[0].push(0);
+    std::atomic<uint64_t> total(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w]() {
+            WorkStealingDeque<int>& own = deques[w];
+            uint32_t victim = 2463534242u + w;
+            uint64_t sum = 0;
+            auto spawn = [&](int node) { own.push(node); };
+            while (!tree.done.load(std::memory_order_acquire)) {
+                int node;
+                if (own.pop(node)) {
+                    sum += tree.run(node, spawn);
+                    continue;
+                }
+                victim ^= victim << 13;
+                victim ^= victim >> 17;
+                victim ^= victim << 5;
+                int other = (int)(victim % threads);
+                if (other != w && deques[other].steal(node)) {
+                    sum += tree.run(node, spawn);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            total += sum;
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (int w = 0; w < threads; ++w) {
+        deques[w].~WorkStealingDeque<int>();
+    }
+    ::operator delete(deques, std::align_val_t(64));
+    checksum = total;
+    return seconds;
+}
+
+/**
+ * @brief Сравнение планировщиков на fork-join дереве для 1..maxThreads потоков.
+ */
+void benchmarkSchedulers(int depth, int leafWork, int maxThreads) {
+    std::cout << "Fork-join tree: depth " << depth << ", " << (1 << depth) << " leaves x "
+              << leafWork << " iterations\n";
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        uint64_t fifoSum, stealSum;
+        double fifo = runFifoScheduler(threads, depth, leafWork, fifoSum);
+        double steal = runStealingScheduler(threads, depth, leafWork, stealSum);
+        std::cout << threads << " threads: FIFO " << fifo * 1000 << " ms, work-stealing "
+                  << steal * 1000 << " ms, speedup " << fifo / steal
+                  << (fifoSum == stealSum ? "" : " (checksum mismatch!)") << "\n";
+    }
+}
+
+/**
+ * @brief Замер кучи: count вставок и извлечений для двоичной и 4-арной кучи.
+ */
+template<int D>
+void benchmarkHeap(int count) {
+    DaryHeap<uint32_t, D> heap;
+    uint32_t x = 12345;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        x = x * 1664525u + 1013904223u;
+        heap.push(x);
+    }
+    uint32_t value, previous = UINT32_MAX;
+    bool ordered = true;
+    while (heap.try_pop(value)) {
+        ordered = ordered && value <= previous;
+        previous = value;
+    }
+    std::cout << D << "-ary heap: " << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start).count()
+              << " ms" << (ordered ? "" : " (order violated!)") << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        // Сравнение реализаций очереди: bench [количество элементов]
+        int count = argc > 2 ? std::stoi(argv[2]) : 10000000;
+        benchmarkQueue<Queue<int>>("Linked list", count);
+        benchmarkQueue<RingQueue<int>>("Ring buffer", count);
+        benchmarkQueue<BlockQueue<int>>("Unrolled list", count);
+        benchmarkMoves(count / 10);
+        benchmarkHeap<2>(count / 10);
+        benchmarkHeap<4>(count / 10);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "concurrent") {
+        // Конкурентные очереди: concurrent [количество элементов] [макс. число потоков]
+        long long count = argc > 2 ? std::stoll(argv[2]) : 2000000;
+        int maxThreads = argc > 3 ? std::stoi(argv[3]) : std::max(2u, std::thread::hardware_concurrency());
+        benchmarkConcurrent<SpscQueue<uint64_t>>("SPSC", 1, 1, count);
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            benchmarkConcurrent<MpmcQueue<uint64_t>>("MPMC", threads, threads, count);
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "blocking") {
+        // Блокирующая очередь против опроса: blocking [количество элементов]
+        benchmarkBlocking(argc > 2 ? std::stoi(argv[2]) : 200000);
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "scheduler") {
+        // Планировщики задач: scheduler [глубина дерева] [работа в листе] [макс. число потоков]
+        int depth = argc > 2 ? std::stoi(argv[2]) : 16;
+        int leafWork = argc > 3 ? std::stoi(argv[3]) : 2000;
+        int maxThreads = argc > 4 ? std::stoi(argv[4]) : std::max(2u, std::thread::hardware_concurrency());
+        benchmarkSchedulers(depth, leafWork, maxThreads);
+        return 0;
+    }
+
+    Queue<int> q;
+
+    int choice;
+    do {
+        std::cout << "\nSelect operation:\n";
+        std::cout << "1. Get queue size\n";
+        std::cout << "2. Add element to end\n";
+        std::cout << "3. Get element from start\n";
+        std::cout << "4. Remove element from beginning\n";
+        std::cout << "0. Exit\n";
+
+        std::cin >> choice;
+
+        switch (choice) {
+            case 1:
+                q.printQueue();
+                std::cout << "Queue size: " << q.size << "\n";
+                break;
+            case 2:
+                q.printQueue();
+                std::cout << "Enter value: ";
+                int value;
+                std::cin >> value;
+                q.enqueue(value);
+                std::cout << std::endl;
+                q.printQueue();
+                break;
+            case 3:
+                q.printQueue();
+                if (q.peek() != nullptr) {
+                    std::cout << "Element from start: " << *q.peek() << std::endl;
+                }
                 break;
             case 4:
             
                 if (q.peek() == nullptr){
+                    std::cout << "Queue is empty!\n";
                     break;
                 }
                 q.printQueue();
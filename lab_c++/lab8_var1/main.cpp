@@ -2,6 +2,24 @@
 #include <vector>
 #include <ctime>
 #include <random>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <array>
+#include <utility>
+
+// Запись бинарного журнала боя: -DBATTLE_LOG=0 убирает ее из программы целиком
+#ifndef BATTLE_LOG
+#define BATTLE_LOG 1
+#endif
 
 // Класс Tower (Башня)
 class Tower {
@@ -44,50 +62,148 @@ public:
     int numTowers;
     std::vector<Tower> towers;
     int allCastelDamage;
+    int aliveCount;             // Количество целых башен
+    std::vector<int> aliveIds;  // Номера целых башен в первых aliveCount ячейках
+    std::vector<int> alivePos;  // Позиция башни в aliveIds, -1 для разрушенной
+
+    Castle() : Castle(rand() % 6 + 3) {}
 
-    Castle() {
-        numTowers = rand() % 6 + 3;
-        towers.resize(numTowers);
-        allCastelDamage = 0;
+    /**
+     * @brief Замок с заданным количеством башен.
+     * @param numTowers Количество башен.
+     */
+    explicit Castle(int numTowers)
+        : numTowers(numTowers), towers(numTowers), allCastelDamage(0), aliveCount(numTowers),
+          aliveIds(numTowers), alivePos(numTowers) {
+        for (int i = 0; i < numTowers; i++) {
+            aliveIds[i] = i;
+            alivePos[i] = i;
+        }
+    }
+
+    /**
+     * @brief Номер башни на кольце со смещением offset от center.
+     */
+    int ringTower(int center, int offset) const {
+        return ((center + offset) % numTowers + numTowers) % numTowers;
+    }
+
+    /**
+     * @brief Башни, атакуемые вокруг центральной: от center - Radius до center + Radius.
+     * @param center Центральная башня.
+     * @param tower_numbers Массив на 2 * Radius + 1 номеров, центр - в середине.
+     */
+    template<int Radius>
+    void attackWindow(int center, int tower_numbers[]) const {
+        for (int i = 0; i < 2 * Radius + 1; i++) {
+            tower_numbers[i] = ringTower(center, i - Radius);
+        }
+    }
+
+    /**
+     * @brief Номер слота окна, по которому бьет голова i.
+     *
+     * Полные проходы по окну идут слева направо (при Heads == Width голова i бьет
+     * слот i), оставшиеся головы расходятся от центрального слота: центр, левый,
+     * правый, второй слева и т.д. Так центральная башня всегда под ударом.
+     * @tparam Heads Количество голов дракона.
+     * @tparam Width Количество атакуемых башен.
+     * @param i Номер головы.
+     */
+    template<int Heads, int Width>
+    static constexpr int headSlot(int i) {
+        constexpr int full = Heads / Width * Width;
+        if (i < full) {
+            return i % Width;
+        }
+        int k = i - full;
+        int offset = (k + 1) / 2;
+        return Width / 2 + (k % 2 ? -offset : offset);
     }
 
     /**
      * @brief Уменьшает прочность указанных башен в соответствии с переданными значениями урона.
+     *
+     * Голова i бьет башню tower_numbers[headSlot<Heads, Width>(i)].
+     * @tparam Heads Количество голов дракона.
+     * @tparam Width Количество атакуемых башен.
      * @param dragon_damage Массив с уроном от каждой головы дракона.
      * @param tower_numbers Массив с номерами башен, на которые направлен урон.
      */
-    void getCastleDamage(int dragon_damage[], int tower_numbers[]) {
-        int len = 3;
-        for (int i = 0; i < len; i++) {
-            towers[tower_numbers[i]].getTowerDamage(dragon_damage[i]);
+    template<int Heads = 3, int Width = 3>
+    void getCastleDamage(const int dragon_damage[], const int tower_numbers[]) {
+        for (int i = 0; i < Heads; i++) {
+            int number = tower_numbers[headSlot<Heads, Width>(i)];
+            Tower& tower = towers[number];
+            bool wasAlive = tower.isAlive();
+            tower.getTowerDamage(dragon_damage[i]);
+            if (wasAlive && !tower.isAlive()) {
+                removeAlive(number);
+            }
         }
     }
 
     /**
      * @brief Выполняет атаку замка, атакует указанные башни.
      * @param tower_numbers Массив с номерами башен, которые будут атаковать.
+     * @param tower_damage Если задан, сюда записывается урон каждой башни (0, если не стреляла).
+     * @tparam Width Количество атакуемых башен.
      * @return Общий урон, нанесенный замком.
      */
-    int castleAttack(int tower_numbers[]) {
+    template<int Width = 3>
+    int castleAttack(const int tower_numbers[], int tower_damage[] = nullptr) {
         int total_damage = 0;
-        int len = 3;
-        for (int i = 0; i < len; i++) {
+        for (int i = 0; i < Width; i++) {
+            int damage = 0;
             if (tower_numbers[i] >= 0 && tower_numbers[i] < numTowers && towers[tower_numbers[i]].isAlive()) {
-                int damage = towers[tower_numbers[i]].attack();
+                damage = towers[tower_numbers[i]].attack();
                 total_damage += damage;
             }
+            if (tower_damage) {
+                tower_damage[i] = damage;
+            }
         }
         allCastelDamage += total_damage;
         return total_damage;
     }
 
-    int getAliveTowers(){
-        int aliveTowers = numTowers;
+    /**
+     * @brief Количество целых башен за O(1).
+     */
+    int getAliveTowers() const {
+        return aliveCount;
+    }
+
+    /**
+     * @brief Подсчет целых башен полным проходом (для проверки счетчика).
+     */
+    int countAliveTowers() const {
+        int aliveTowers = 0;
         for (int i = 0; i < numTowers; i++) {
-            aliveTowers = (towers[i].health <= 0) ? --aliveTowers : aliveTowers;
+            aliveTowers += towers[i].isAlive();
         }
         return aliveTowers;
     }
+
+    /**
+     * @brief Номер k-й целой башни (порядок произвольный).
+     * @param k Индекс от 0 до getAliveTowers() - 1.
+     */
+    int aliveTower(int k) const {
+        return aliveIds[k];
+    }
+
+    /**
+     * @brief Исключение разрушенной башни: на ее место встает последняя целая.
+     * @param id Номер башни.
+     */
+    void removeAlive(int id) {
+        int pos = alivePos[id];
+        int last = aliveIds[--aliveCount];
+        aliveIds[pos] = last;
+        alivePos[last] = pos;
+        alivePos[id] = -1;
+    }
     
     void getCastelStatistic(){
         std::cout << "All Castle damage: " << allCastelDamage << std::endl; 
@@ -98,14 +214,17 @@ public:
     }
 };
 
-// Класс Dragon (Дракон)
-class Dragon {
+// Класс Dragon (Дракон) с Heads головами
+template<int Heads>
+class BasicDragon {
 public:
+    static_assert(Heads >= 1 && Heads <= 8, "Dragon has 1..8 heads");
+
     int health;
-    int headDamage[3] = {0, 0, 0};  // Урон каждой из трех голов
+    int headDamage[Heads] = {};  // Урон каждой из голов
     int totalDamage; // Суммарный урон дракона
 
-    Dragon() : health(625), totalDamage(0) {}
+    BasicDragon() : health(625), totalDamage(0) {}
 
     /**
      * @brief Выбирает центральную башню для атаки.
@@ -117,12 +236,23 @@ public:
     }
 
     /**
-     * @brief Атакует три башни и наносит урон каждой.
+     * @brief Выбирает центральную башню среди целых за O(1).
+     *
+     * Распределение то же, что у повторного выбора mainTower(numTowers) до попадания
+     * в целую башню, но без холостых попыток, когда башен осталось мало.
+     * @param castle Атакуемый замок (должна быть хотя бы одна целая башня).
+     * @return Номер выбранной башни.
+     */
+    int mainTower(const Castle& castle) {
+        return castle.aliveTower(rand() % castle.getAliveTowers());
+    }
+
+    /**
+     * @brief Атакует башни всеми головами.
      * @param dragonAttack Массив для хранения урона от каждой головы.
      */
     void attackTowers(int dragonAttack[]) {
-        int len = 3;
-        for (int i = 0; i < len; i++) {
+        for (int i = 0; i < Heads; i++) {
             int damage = rand() % 31 + 20;
             dragonAttack[i] = damage;
             headDamage[i] += damage;
@@ -149,41 +279,187 @@ public:
  
     void getDragonStatistic(){
         std::cout << "All Dragon damage: " << totalDamage << std::endl;
-        int len = 3; 
-        for (int i = 0; i < len; i++) {
+        for (int i = 0; i < Heads; i++) {
             std::cout << "Damage of dragon head " << i << ": " << headDamage[i] << std::endl;
         }
         std::cout << "Dragon health: " << health << std::endl;
     }
 };
 
-   
+using Dragon = BasicDragon<3>;
+
+/**
+ * @brief Событие журнала: один раунд боя, 32 байта.
+ */
+struct BattleEvent {
+    uint32_t round;         // Номер раунда
+    int32_t dragonHealth;   // Здоровье дракона после раунда
+    int32_t targets[3];     // Атакованные башни
+    uint8_t heads[3];       // Урон голов дракона
+    uint8_t shots[3];       // Ответный урон башен (0 - башня не стреляла)
+    uint8_t towerHealth[3]; // Прочность башен после удара
+    uint8_t strategy;       // Стратегия
+    uint16_t battle;        // Номер боя
+};
+static_assert(sizeof(BattleEvent) == 32, "BattleEvent must stay 32 bytes");
+
+/**
+ * @brief Бинарный журнал боя в заранее выделенном кольцевом буфере.
+ *
+ * Запись раунда - копирование 32 байт в массив по маске индекса, без выделения
+ * памяти и форматирования. При переполнении хранятся последние capacity событий.
+ * Текст строится отдельно, из сохраненного файла, функцией decode.
+ * Журнал ведут simulateBattleStrategyFirst/Second; пакетный BattleBatch его не пишет.
+ */
+class BattleLog {
+public:
+    static constexpr bool enabled = BATTLE_LOG != 0;  // Запись включена при компиляции
+    static constexpr uint32_t magic = 0x474F4C44;     // "DLOG"
+
+    /**
+     * @brief Заголовок файла журнала.
+     */
+    struct Header {
+        uint32_t magic;
+        uint32_t eventSize;
+        uint64_t recorded;  // Всего записано событий
+        uint64_t stored;    // Сохранено в файле (последние)
+    };
+
+    std::vector<BattleEvent> events;  // Кольцевой буфер
+    uint64_t recorded;                // Всего записано событий
+    uint64_t mask;                    // Емкость минус один
+    uint16_t battle;                  // Номер текущего боя
+
+    /**
+     * @brief Конструктор.
+     * @param capacity Емкость буфера (округляется вверх до степени двойки)
+     */
+    explicit BattleLog(size_t capacity = 1 << 16) : recorded(0), battle(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        events.resize(size);
+        mask = size - 1;
+    }
+
+    /**
+     * @brief Запись раунда.
+     * @param strategy Стратегия
+     * @param round Номер раунда
+     * @param targets Атакованные башни
+     * @param heads Урон голов дракона
+     * @param shots Ответный урон башен
+     * @param castle Замок после раунда
+     * @param dragonHealth Здоровье дракона после раунда
+     */
+    void record(int strategy, int round, const int targets[3], const int heads[3], const int shots[3],
+                const Castle& castle, int dragonHealth) {
+        BattleEvent& e = events[recorded++ & mask];
+        e.round = round;
+        e.dragonHealth = dragonHealth;
+        e.strategy = (uint8_t)strategy;
+        e.battle = battle;
+        for (int i = 0; i < 3; i++) {
+            e.targets[i] = targets[i];
+            e.heads[i] = (uint8_t)heads[i];
+            e.shots[i] = (uint8_t)shots[i];
+            e.towerHealth[i] = (uint8_t)castle.towers[targets[i]].health;
+        }
+    }
+
+    /**
+     * @brief Сохранение журнала в файл (события от старых к новым).
+     * @return false, если файл не удалось записать.
+     */
+    bool save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        uint64_t stored = std::min<uint64_t>(recorded, events.size());
+        Header header{magic, sizeof(BattleEvent), recorded, stored};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (uint64_t i = recorded - stored; i < recorded; ++i) {
+            out.write(reinterpret_cast<const char*>(&events[i & mask]), sizeof(BattleEvent));
+        }
+        return bool(out);
+    }
+
+    /**
+     * @brief Перевод бинарного журнала в текст.
+     * @param path Файл журнала
+     * @param out Поток для текста
+     * @return false, если файл не журнал боя.
+     */
+    static bool decode(const std::string& path, std::ostream& out) {
+        std::ifstream in(path, std::ios::binary);
+        Header header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != magic ||
+            header.eventSize != sizeof(BattleEvent)) {
+            std::cerr << path << ": not a battle log" << std::endl;
+            return false;
+        }
+        if (header.recorded > header.stored) {
+            out << "(" << header.recorded - header.stored << " earlier events were overwritten)\n";
+        }
+        BattleEvent e;
+        int lastBattle = -1;
+        while (in.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+            if (e.battle != lastBattle) {
+                out << "Battle " << e.battle << ", strategy " << int(e.strategy) << "\n";
+                lastBattle = e.battle;
+            }
+            out << "Round " << e.round << ": dragon hits towers";
+            for (int i = 0; i < 3; i++) {
+                out << " " << e.targets[i] << " (-" << int(e.heads[i]) << ", " << int(e.towerHealth[i]) << " left)";
+            }
+            out << "; towers hit back " << int(e.shots[0]) << "+" << int(e.shots[1]) << "+" << int(e.shots[2])
+                << " = " << e.shots[0] + e.shots[1] + e.shots[2] << "; dragon health " << e.dragonHealth << "\n";
+        }
+        return true;
+    }
+};
+
 /**
  * @brief Моделирует бой по первой стратегии.
+ * @tparam Heads Количество голов дракона.
+ * @tparam Radius Сколько соседних башен с каждой стороны центральной атакуется и отвечает.
  * @param castle Ссылка на объект замка.
  * @param dragon Ссылка на объект дракона.
  * @param round Ссылка на счетчик раундов.
+ * @param verbose Печатать ли ход боя.
+ * @param log Журнал боя (nullptr - не вести).
  */
-void simulateBattleStrategyFirst(Castle &castle, Dragon &dragon, int &round) {
-    std::cout << "Starting Battle - Strategy 1" << std::endl;
+template<int Heads, int Radius = 1>
+void simulateBattleStrategyFirst(Castle &castle, BasicDragon<Heads> &dragon, int &round, bool verbose = true,
+                                 BattleLog* log = nullptr) {
+    const int width = 2 * Radius + 1;
+    if (verbose) std::cout << "Starting Battle - Strategy 1" << std::endl;
     while (dragon.isAlive() && castle.getAliveTowers() > 0) {
         
-        int towers_numbers[3];
-        towers_numbers[1] = dragon.mainTower(castle.numTowers);
-        if (castle.towers[towers_numbers[1]].isAlive()) {
+        int center = dragon.mainTower(castle);
+        if (castle.towers[center].isAlive()) {
             ++round;
-            towers_numbers[0] = (towers_numbers[1] == 0) ? castle.numTowers - 1 : towers_numbers[1] - 1;
-            towers_numbers[2] = (towers_numbers[1] == castle.numTowers - 1) ? 0 : towers_numbers[1] + 1;
+            int towers_numbers[width];
+            castle.attackWindow<Radius>(center, towers_numbers);
 
-            int dragonAttack[3];
+            int dragonAttack[Heads];
             dragon.attackTowers(dragonAttack);
 
-            castle.getCastleDamage(dragonAttack, towers_numbers);
+            castle.getCastleDamage<Heads, width>(dragonAttack, towers_numbers);
 
-            int castle_damage = castle.castleAttack(towers_numbers);
+            int shots[width];
+            int castle_damage = castle.castleAttack<width>(towers_numbers, shots);
             dragon.getTowerDamage(castle_damage);
+            if constexpr (Heads == 3 && Radius == 1) {
+                if (BattleLog::enabled && log) {
+                    log->record(1, round, towers_numbers, dragonAttack, shots, castle, dragon.health);
+                }
+            }
         }
     }
+    if (!verbose) {
+        return;
+    }
     (dragon.isAlive() == false) ? std::cout << "Sir, the Dragon is dead!\n\n" : std::cout << "Sir, Towers fell!\n\n";
 
     std::cout << "End of Battle - Strategy 1" << std::endl;
@@ -191,33 +467,48 @@ void simulateBattleStrategyFirst(Castle &castle, Dragon &dragon, int &round) {
 
 /**
  * @brief Моделирует бой по второй стратегии.
+ * @tparam Heads Количество голов дракона.
+ * @tparam Radius Сколько соседних башен с каждой стороны центральной атакуется и отвечает.
  * @param castle Ссылка на объект замка.
  * @param dragon Ссылка на объект дракона.
  * @param round Ссылка на счетчик раундов.
+ * @param verbose Печатать ли ход боя.
+ * @param log Журнал боя (nullptr - не вести).
  */
-void simulateBattleStrategySecond(Castle &castle, Dragon &dragon, int &round) {
-    std::cout << "Starting Battle - Strategy 2" << std::endl;
+template<int Heads, int Radius = 1>
+void simulateBattleStrategySecond(Castle &castle, BasicDragon<Heads> &dragon, int &round, bool verbose = true,
+                                  BattleLog* log = nullptr) {
+    const int width = 2 * Radius + 1;
+    if (verbose) std::cout << "Starting Battle - Strategy 2" << std::endl;
     while (dragon.isAlive() && castle.getAliveTowers() > 0) {
         
-        int towers_numbers[3];
-        towers_numbers[1] = dragon.mainTower(castle.numTowers);
+        int center = dragon.mainTower(castle);
 
-        if (castle.towers[towers_numbers[1]].isAlive()) {
+        if (castle.towers[center].isAlive()) {
 
-            towers_numbers[0] = (towers_numbers[1] == 0) ? castle.numTowers - 1 : towers_numbers[1] - 1;
-            towers_numbers[2] = (towers_numbers[1] == castle.numTowers - 1) ? 0 : towers_numbers[1] + 1;
+            int towers_numbers[width];
+            castle.attackWindow<Radius>(center, towers_numbers);
 
-            while (castle.towers[towers_numbers[1]].isAlive() && dragon.isAlive()) {
+            while (castle.towers[center].isAlive() && dragon.isAlive()) {
                 ++round;
-                int dragonAttack[3];
+                int dragonAttack[Heads];
                 dragon.attackTowers(dragonAttack);
-                castle.getCastleDamage(dragonAttack, towers_numbers);
+                castle.getCastleDamage<Heads, width>(dragonAttack, towers_numbers);
 
-                int castle_damage = castle.castleAttack(towers_numbers);
+                int shots[width];
+                int castle_damage = castle.castleAttack<width>(towers_numbers, shots);
                 dragon.getTowerDamage(castle_damage);
+                if constexpr (Heads == 3 && Radius == 1) {
+                    if (BattleLog::enabled && log) {
+                        log->record(2, round, towers_numbers, dragonAttack, shots, castle, dragon.health);
+                    }
+                }
             }
         }
     }
+    if (!verbose) {
+        return;
+    }
     (dragon.isAlive() == false) ? std::cout << "Sir, the Dragon is dead!\n\n" : std::cout << "Sir, Towers fell!\n\n";
 
     std::cout << "End of Battle - Strategy 2" << std::endl;
@@ -229,13 +520,1103 @@ void simulateBattleStrategySecond(Castle &castle, Dragon &dragon, int &round) {
  * @param dragon Ссылка на объект дракона.
  * @param round Количество раундов.
  */
-void statistic(Castle &castle, Dragon &dragon, int round){
+template<int Heads>
+void statistic(Castle &castle, BasicDragon<Heads> &dragon, int round){
     dragon.getDragonStatistic();
     castle.getCastelStatistic();
     std::cout << "Number of rounds: " << round << std::endl;
 }
 
-int main() {
+/**
+ * @brief Счетчиковый генератор случайных чисел, тот же, что randomHash в lab5_var1.
+ */
+inline uint32_t randomHash(uint32_t seed, uint32_t a, uint32_t b, uint32_t c) {
+    uint32_t x = seed + a * 0x9E3779B9u + b * 0x85EBCA6Bu + c * 0xC2B2AE35u;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/**
+ * @brief Случайное число из [0, n) по 16 старшим битам хеша (n < 65536).
+ */
+inline int randomBelow(uint32_t hash, int n) {
+    return (int)(((hash >> 16) * (uint32_t)n) >> 16);
+}
+
+/**
+ * @brief Пакет независимых боев, которые идут синхронно, такт за тактом.
+ *
+ * Состояние хранится по столбцам (SoA): здоровье драконов, текущие цели, раунды;
+ * башни каждого боя лежат подряд блоком из maxTowers, так что шаг между боями
+ * известен при компиляции. За такт каждый бой выбирает центральную башню, дракон бьет
+ * тремя головами, уцелевшие атакованные башни отвечают - все как в
+ * simulateBattleStrategyFirst/Second. Выбор башен сделан масками, а не индексами,
+ * поэтому цикл по боям векторизуется, а завершенные бои просто маскируются.
+ */
+class BattleBatch {
+public:
+    static const int maxTowers = 8;       // Столько башен бывает в Castle
+    static const int defaultLanes = 4096; // Боев в одном пакете
+
+    int lanes;             // Количество боев
+    int numTowers;         // Количество башен в каждом бою
+    bool sticky;           // Стратегия 2: бить одну башню до разрушения
+    uint32_t seed;         // Зерно генератора
+    uint32_t firstBattle;  // Номер первого боя (для независимых потоков случайных чисел)
+    std::vector<int> dragonHealth;
+    std::vector<int> towerHealth;  // По maxTowers башен на бой, подряд
+    std::vector<int> target;       // Текущая центральная башня
+    std::vector<int> rounds;       // Проведенные раунды
+    std::vector<int> done;         // Бой завершен
+
+    /**
+     * @brief Конструктор.
+     * @param lanes Количество боев
+     * @param numTowers Количество башен (3..maxTowers)
+     * @param health Начальное здоровье дракона
+     * @param strategy Номер стратегии (1 или 2)
+     * @param seed Зерно генератора
+     * @param firstBattle Номер первого боя пакета
+     */
+    BattleBatch(int lanes, int numTowers, int health, int strategy, uint32_t seed, uint32_t firstBattle = 0)
+        : lanes(lanes), numTowers(numTowers), sticky(strategy == 2), seed(seed), firstBattle(firstBattle),
+          dragonHealth(lanes, health), towerHealth(maxTowers * lanes, 0), target(lanes, 0),
+          rounds(lanes, 0), done(lanes, 0) {
+        for (int m = 0; m < lanes; ++m) {
+            std::fill_n(towerHealth.begin() + m * maxTowers, numTowers, 100);
+        }
+    }
+
+    /**
+     * @brief Моделирование до завершения всех боев пакета.
+     */
+    void run() {
+        int active = lanes;
+        for (uint32_t tick = 0; active > 0; ++tick) {
+            active = step(tick, dragonHealth.data(), towerHealth.data(), target.data(), rounds.data(), done.data());
+        }
+    }
+
+    /**
+     * @brief Количество боев, в которых дракон разрушил все башни.
+     */
+    int dragonWins() const {
+        int wins = 0;
+        for (int m = 0; m < lanes; ++m) {
+            wins += dragonHealth[m] > 0;
+        }
+        return wins;
+    }
+
+    /**
+     * @brief Суммарное число раундов по всем боям пакета.
+     */
+    long long totalRounds() const {
+        long long total = 0;
+        for (int m = 0; m < lanes; ++m) {
+            total += rounds[m];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Один такт (раунд) всех боев пакета.
+     *
+     * Массивы передаются как restrict-указатели, а ветвления заменены масками,
+     * чтобы компилятор векторизовал цикл по боям.
+     * @return Количество еще не завершенных боев
+     */
+    int step(uint32_t tick, int* __restrict dragons, int* __restrict towers, int* __restrict targets,
+             int* __restrict roundCount, int* __restrict finished) const {
+        const int count = lanes;
+        const int n = numTowers;
+        const uint32_t key = seed;
+        const uint32_t base = firstBattle;
+        const int keep = sticky;
+        int active = 0;
+
+        for (int m = 0; m < count; ++m) {
+            const uint32_t id = base + m;
+            int* __restrict health = towers + m * maxTowers;
+            // Центр выбирается сразу среди целых башен: это то же распределение, что и
+            // повторный выбор до целой башни в исходном цикле, но без пустых тактов
+            int alive = 0;
+            int currentHealth = 0;
+            for (int t = 0; t < maxTowers; ++t) {
+                alive += health[t] > 0;
+                currentHealth += (t == targets[m]) * health[t];
+            }
+            int pick = randomBelow(randomHash(key, id, tick, 0), alive);
+            int picked = 0;
+            int seen = 0;
+            for (int t = 0; t < maxTowers; ++t) {
+                int up = health[t] > 0;
+                picked += t * (up & (seen == pick));
+                seen += up;
+            }
+            // Стратегия 2 держит прежнюю цель, пока она цела
+            int center = (keep & (currentHealth > 0)) ? targets[m] : picked;
+            int act = !finished[m];
+            int left = center == 0 ? n - 1 : center - 1;
+            int right = center == n - 1 ? 0 : center + 1;
+
+            int head0 = 20 + randomBelow(randomHash(key, id, tick, 1), 31);
+            int head1 = 20 + randomBelow(randomHash(key, id, tick, 2), 31);
+            int head2 = 20 + randomBelow(randomHash(key, id, tick, 3), 31);
+            int shot0 = 20 + randomBelow(randomHash(key, id, tick, 4), 31);
+            int shot1 = 20 + randomBelow(randomHash(key, id, tick, 5), 31);
+            int shot2 = 20 + randomBelow(randomHash(key, id, tick, 6), 31);
+
+            int castleDamage = 0;
+            alive = 0;
+            for (int t = 0; t < maxTowers; ++t) {
+                int isLeft = t == left, isCenter = t == center, isRight = t == right;
+                int hit = isLeft * head0 + isCenter * head1 + isRight * head2;
+                int h = health[t] - act * hit;
+                h = h < 0 ? 0 : h;
+                health[t] = h;
+                castleDamage += act * (h > 0) * (isLeft * shot0 + isCenter * shot1 + isRight * shot2);
+                alive += h > 0;
+            }
+            int dragon = dragons[m] - castleDamage;
+            dragon = dragon < 0 ? 0 : dragon;
+            dragons[m] = dragon;
+            targets[m] = center;
+            roundCount[m] += act;
+            int over = (dragon == 0) | (alive == 0);
+            finished[m] = over;
+            active += !over;
+        }
+        return active;
+    }
+};
+
+/**
+ * @brief Результат серии боев.
+ */
+struct WinRate {
+    long long battles;  // Количество боев
+    long long wins;     // Победы дракона
+    long long rounds;   // Суммарное число раундов
+
+    double rate() const {
+        return battles ? double(wins) / battles : 0;
+    }
+};
+
+/**
+ * @brief Оценка доли побед дракона пакетным движком.
+ *
+ * Количество башен равномерно от 3 до 8, как в конструкторе Castle.
+ * @param strategy Номер стратегии (1 или 2)
+ * @param health Начальное здоровье дракона
+ * @param battles Количество боев
+ * @param seed Зерно генератора
+ */
+WinRate estimateWinRate(int strategy, int health, long long battles, uint32_t seed) {
+    WinRate result{0, 0, 0};
+    const int sizes = BattleBatch::maxTowers - 2;
+    uint32_t battleId = 0;
+    for (int size = 0; size < sizes; ++size) {
+        long long share = battles / sizes + (size < battles % sizes ? 1 : 0);
+        for (long long done = 0; done < share; done += BattleBatch::defaultLanes) {
+            int lanes = (int)std::min<long long>(BattleBatch::defaultLanes, share - done);
+            BattleBatch batch(lanes, 3 + size, health, strategy, seed, battleId);
+            batch.run();
+            battleId += lanes;
+            result.battles += lanes;
+            result.wins += batch.dragonWins();
+            result.rounds += batch.totalRounds();
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Та же оценка по одному бою за раз через исходные классы и rand().
+ */
+WinRate estimateWinRateScalar(int strategy, long long battles) {
+    WinRate result{0, 0, 0};
+    for (long long i = 0; i < battles; ++i) {
+        Castle castle;
+        Dragon dragon;
+        int round = 0;
+        if (strategy == 1) {
+            simulateBattleStrategyFirst(castle, dragon, round, false);
+        } else {
+            simulateBattleStrategySecond(castle, dragon, round, false);
+        }
+        result.battles += 1;
+        result.wins += dragon.isAlive();
+        result.rounds += round;
+    }
+    return result;
+}
+
+/**
+ * @brief Серия боев для дракона с Heads головами и радиусом атаки Radius.
+ * @param strategy Номер стратегии (1 или 2)
+ * @param numTowers Количество башен (не меньше 2 * Radius + 1)
+ * @param health Начальное здоровье дракона
+ * @param battles Количество боев
+ */
+template<int Heads, int Radius>
+WinRate runVariant(int strategy, int numTowers, int health, long long battles) {
+    WinRate result{0, 0, 0};
+    for (long long i = 0; i < battles; ++i) {
+        Castle castle(numTowers);
+        BasicDragon<Heads> dragon;
+        dragon.health = health;
+        int round = 0;
+        if (strategy == 1) {
+            simulateBattleStrategyFirst<Heads, Radius>(castle, dragon, round, false);
+        } else {
+            simulateBattleStrategySecond<Heads, Radius>(castle, dragon, round, false);
+        }
+        result.battles += 1;
+        result.wins += dragon.isAlive();
+        result.rounds += round;
+    }
+    return result;
+}
+
+/**
+ * @brief Таблица заранее собранных вариантов: голов 1..maxHeads, радиус 0..maxRadius.
+ */
+struct Variants {
+    static const int maxHeads = 8;
+    static const int maxRadius = 3;
+
+    using Runner = WinRate (*)(int strategy, int numTowers, int health, long long battles);
+
+    template<int Heads, int... Radius>
+    static constexpr std::array<Runner, maxRadius + 1> row(std::integer_sequence<int, Radius...>) {
+        return {&runVariant<Heads, Radius>...};
+    }
+
+    template<int... Heads>
+    static constexpr std::array<std::array<Runner, maxRadius + 1>, maxHeads> table(std::integer_sequence<int, Heads...>) {
+        return {row<Heads + 1>(std::make_integer_sequence<int, maxRadius + 1>())...};
+    }
+
+    /**
+     * @brief Выбор собранного варианта по значениям, известным только во время работы.
+     * @return nullptr, если такого варианта нет.
+     */
+    static Runner find(int heads, int radius) {
+        static constexpr auto runners = table(std::make_integer_sequence<int, maxHeads>());
+        if (heads < 1 || heads > maxHeads || radius < 0 || radius > maxRadius) {
+            return nullptr;
+        }
+        return runners[heads - 1][radius];
+    }
+};
+
+/**
+ * @brief Доли побед дракона по всем вариантам голов и радиусов для обеих стратегий.
+ */
+void printVariants(int numTowers, int health, long long battles) {
+    std::cout << numTowers << " towers, dragon health " << health << ", " << battles
+              << " battles per cell; dragon wins, strategy 1 / strategy 2" << std::endl;
+    std::cout << "Heads";
+    for (int radius = 0; radius <= Variants::maxRadius; ++radius) {
+        std::cout << std::setw(16) << ("radius " + std::to_string(radius));
+    }
+    std::cout << std::endl << std::fixed << std::setprecision(1);
+    for (int heads = 1; heads <= Variants::maxHeads; ++heads) {
+        std::cout << std::setw(5) << heads;
+        for (int radius = 0; radius <= Variants::maxRadius; ++radius) {
+            Variants::Runner run = Variants::find(heads, radius);
+            if (2 * radius + 1 > numTowers) {
+                std::cout << std::setw(16) << "-";
+                continue;
+            }
+            double first = run(1, numTowers, health, battles).rate() * 100;
+            double second = run(2, numTowers, health, battles).rate() * 100;
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(1) << first << "/" << second;
+            std::cout << std::setw(16) << cell.str();
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
+
+/**
+ * @brief Сравнение пакетного и поединочного движков по доле побед и скорости.
+ */
+void compareEngines(long long battles, uint32_t seed) {
+    using Clock = std::chrono::steady_clock;
+    srand(seed);
+    for (int strategy = 1; strategy <= 2; ++strategy) {
+        auto t0 = Clock::now();
+        WinRate batched = estimateWinRate(strategy, 625, battles, seed);
+        auto t1 = Clock::now();
+        long long scalarBattles = std::max(1LL, battles / 10);
+        WinRate scalar = estimateWinRateScalar(strategy, scalarBattles);
+        auto t2 = Clock::now();
+        double batchedMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        double scalarMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        std::cout << "Strategy " << strategy << ": batched " << batched.rate() * 100 << "% dragon wins, "
+                  << double(batched.rounds) / batched.battles << " rounds, " << batchedMs << " ms for "
+                  << batched.battles << " battles; scalar " << scalar.rate() * 100 << "%, "
+                  << double(scalar.rounds) / scalar.battles << " rounds, " << scalarMs << " ms for "
+                  << scalar.battles << " battles (" << scalarMs / scalar.battles / (batchedMs / batched.battles)
+                  << "x per battle)" << std::endl;
+    }
+}
+
+/**
+ * @brief Подбор здоровья дракона, при котором он побеждает в половине боев.
+ *
+ * Для каждого количества башен и стратегии ищет здоровье бисекцией. В каждой точке
+ * бои добавляются порциями, пока 95% доверительный интервал доли побед не отделится
+ * от 50% (или не кончится бюджет - тогда точка и есть ответ). Во всех точках
+ * используются одни и те же номера боев, а значит и одни и те же случайные числа:
+ * при общих случайных числах победа монотонна по здоровью, и бисекция не путается
+ * в шуме. Бои одной порции делятся между потоками пакетами BattleBatch.
+ */
+class Balancer {
+public:
+    int threads;             // Количество потоков
+    uint32_t seed;           // Зерно генератора
+    long long chunk;         // Боев в одной порции
+    long long maxBattles;    // Наибольшее число боев в одной точке
+    double z;                // Квантиль нормального распределения для интервала
+
+    Balancer(int threads, uint32_t seed)
+        : threads(threads), seed(seed), chunk(1 << 14), maxBattles(1 << 21), z(1.96) {}
+
+    /**
+     * @brief Результат подбора для одной конфигурации.
+     */
+    struct Result {
+        int health;        // Найденное здоровье
+        WinRate rate;      // Доля побед в найденной точке
+        long long battles; // Всего смоделировано боев
+        int steps;         // Точек бисекции
+    };
+
+    /**
+     * @brief Параллельное моделирование боев [first, first + count) с фиксированными параметрами.
+     */
+    WinRate simulate(int towers, int strategy, int health, long long first, long long count) const {
+        const int lanes = BattleBatch::defaultLanes;
+        const long long tasks = (count + lanes - 1) / lanes;
+        std::atomic<long long> next(0), wins(0), rounds(0);
+        auto worker = [&]() {
+            long long localWins = 0, localRounds = 0;
+            for (long long task = next++; task < tasks; task = next++) {
+                int size = (int)std::min<long long>(lanes, count - task * lanes);
+                BattleBatch batch(size, towers, health, strategy, seed, (uint32_t)(first + task * lanes));
+                batch.run();
+                localWins += batch.dragonWins();
+                localRounds += batch.totalRounds();
+            }
+            wins += localWins;
+            rounds += localRounds;
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        return WinRate{count, wins, rounds};
+    }
+
+    /**
+     * @brief Сравнение доли побед с 50% с ранней остановкой по доверительному интервалу.
+     * @param rate Накопленная статистика в точке.
+     * @return -1, если доля побед меньше 50%, 1 - если больше, 0 - если не различить.
+     */
+    int compare(int towers, int strategy, int health, WinRate& rate) const {
+        rate = WinRate{0, 0, 0};
+        while (rate.battles < maxBattles) {
+            WinRate part = simulate(towers, strategy, health, rate.battles, chunk);
+            rate.battles += part.battles;
+            rate.wins += part.wins;
+            rate.rounds += part.rounds;
+            double p = rate.rate();
+            double half = z * std::sqrt(std::max(p * (1 - p), 1e-12) / rate.battles);
+            if (p - half > 0.5) {
+                return 1;
+            }
+            if (p + half < 0.5) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Поиск здоровья с долей побед 50% для заданной конфигурации.
+     */
+    Result balance(int towers, int strategy) const {
+        Result result{0, WinRate{0, 0, 0}, 0, 0};
+        WinRate rate;
+        auto probe = [&](int health) {
+            int sign = compare(towers, strategy, health, rate);
+            result.battles += rate.battles;
+            ++result.steps;
+            if (sign == 0) {
+                result.health = health;
+                result.rate = rate;
+            }
+            return sign;
+        };
+
+        // Дракон с 1 единицей здоровья погибает от первого же ответа башен
+        int lo = 1, hi = 256;
+        int sign;
+        while ((sign = probe(hi)) < 0) {
+            lo = hi;
+            hi *= 2;
+        }
+        if (sign == 0) {
+            return result;
+        }
+        WinRate hiRate = rate;
+        while (hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            sign = probe(mid);
+            if (sign == 0) {
+                return result;
+            }
+            if (sign < 0) {
+                lo = mid;
+            } else {
+                hi = mid;
+                hiRate = rate;
+            }
+        }
+        result.health = hi;
+        result.rate = hiRate;
+        return result;
+    }
+
+    /**
+     * @brief Таблица подобранного здоровья для 3..maxTowers башен и обеих стратегий.
+     */
+    void printTable(int minTowers, int maxTowers) const {
+        std::cout << "Towers  Strategy  Health  Win rate  Battles  Steps" << std::endl;
+        for (int towers = minTowers; towers <= maxTowers; ++towers) {
+            for (int strategy = 1; strategy <= 2; ++strategy) {
+                Result r = balance(towers, strategy);
+                std::cout << std::setw(6) << towers << std::setw(10) << strategy << std::setw(8) << r.health
+                          << std::setw(9) << std::fixed << std::setprecision(2) << r.rate.rate() * 100 << "%"
+                          << std::defaultfloat << std::setw(9) << r.battles << std::setw(7) << r.steps << std::endl;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Точный расчет вероятности победы дракона и среднего числа раундов (цепь Маркова).
+ *
+ * Сжатие состояния:
+ * - прочность башни хранится классом: разрушена, 1..20 (умрет от любого удара), 21..80
+ *   или 100 - других значений не бывает, итого 63 класса;
+ * - здоровье дракона не входит в состояние. Урон каждого выстрела башни не зависит от
+ *   хода боя, поэтому дракон жив после k выстрелов с вероятностью q(k) = P(сумма k
+ *   выстрелов < health). Значения считаются как функции от числа выстрелов k;
+ * - башня стреляет, только пережив удар, а пережить их можно не больше четырех
+ *   (100 -> 80 -> 60 -> 40 -> 20), поэтому k не больше 4N.
+ *
+ * Симметрия: раунд с любым центром сводится поворотом к раунду с центром в башне 0.
+ * Значение без цели не меняется при поворотах и отражениях кольца, а значение с целью в
+ * башне 0 - при отражении относительно нее. Эти таблицы хранятся только для канонических
+ * векторов (наименьших среди образов), которых примерно в 2N и в 2 раза меньше.
+ *
+ * Раунд с центром 0 бьет башни N-1, 0, 1 независимыми бросками, и ожидание берется по
+ * одной башне за раз (таблицы afterRight и afterCenter; в них башни неравноправны, и они
+ * хранятся для всех векторов), а не по всем 31^3 сочетаниям. Каждый раунд уменьшает сумму
+ * классов, поэтому состояния считаются по уровням этой суммы. Один удар снижает ее не
+ * больше чем на maxDrop, и таблицы держат только последние maxDrop + 1 уровней. Победы и
+ * раунды считаются отдельными проходами. Так в memoryLimit помещаются замки до 4 башен.
+ */
+class ExactSolver {
+public:
+    static const int classes = 63;      // Классов прочности башни
+    static const int dead = 0;          // Класс разрушенной башни
+    static const int full = classes - 1; // Класс целой башни (100)
+    static constexpr double memoryLimit = 2e9;  // Байт на таблицы
+
+    /**
+     * @brief Результат расчета.
+     */
+    struct Result {
+        double winProbability;  // Вероятность победы дракона
+        double expectedRounds;  // Среднее число раундов
+        long long states;       // Канонических состояний башен
+    };
+
+    /**
+     * @brief Канонические векторы башен, пронумерованные по уровням суммы классов.
+     */
+    struct Numbering {
+        std::vector<int32_t> index;  // Номер канонического образа каждого вектора
+        std::vector<int32_t> order;  // Канонические векторы по уровням
+        std::vector<int32_t> start;  // Начало уровня в order
+        int32_t window = 0;          // Строк в окне таблицы: уровни от l - maxDrop до l
+
+        /**
+         * @brief Строка окна, в которой лежит значение вектора state.
+         */
+        int32_t slot(long long state) const {
+            return index[state] % window;
+        }
+    };
+
+    int towers;     // Количество башен
+    int health;     // Начальное здоровье дракона
+    bool sticky;    // Стратегия 2
+    int shots;      // Наибольшее нужное число выстрелов: дракон точно мертв или 4N
+    int width;      // Длина вектора значения: k = 0..shots
+    int maxDrop;    // Наибольшее снижение класса башни от одного удара
+    long long states;  // Всех векторов башен
+    std::vector<double> alive;  // q(k)
+    std::vector<long long> radix;
+    std::vector<std::vector<std::pair<int, double>>> hit;  // Переходы класса при ударе
+
+    /**
+     * @brief Конструктор.
+     * @param towers Количество башен (3 и больше)
+     * @param health Начальное здоровье дракона
+     * @param strategy Номер стратегии (1 или 2)
+     */
+    ExactSolver(int towers, int health, int strategy)
+        : towers(towers), health(health), sticky(strategy == 2), shots(std::min((health + 19) / 20, 4 * towers)),
+          width(shots + 1), maxDrop(0), states(1), alive(shots + 1), radix(towers + 1), hit(classes) {
+        for (int i = 0; i < towers; ++i) {
+            radix[i] = states;
+            states *= classes;
+        }
+        radix[towers] = states;
+
+        // Распределение суммы k выстрелов, обрезанное на health
+        std::vector<double> sum(health, 0.0), next(health);
+        sum[0] = 1;
+        for (int k = 0; k <= shots; ++k) {
+            double total = 0;
+            for (int d = 0; d < health; ++d) {
+                total += sum[d];
+            }
+            alive[k] = total;
+            std::fill(next.begin(), next.end(), 0.0);
+            for (int d = 0; d < health; ++d) {
+                for (int x = 20; x <= 50 && d + x < health; ++x) {
+                    next[d + x] += sum[d] / 31;
+                }
+            }
+            sum.swap(next);
+        }
+
+        for (int c = 1; c < classes; ++c) {
+            for (int roll = 20; roll <= 50; ++roll) {
+                int after = classOf(std::max(valueOf(c) - roll, 0));
+                maxDrop = std::max(maxDrop, c - after);
+                auto& list = hit[c];
+                auto same = std::find_if(list.begin(), list.end(),
+                                         [after](const std::pair<int, double>& e) { return e.first == after; });
+                if (same == list.end()) {
+                    list.push_back({after, 1.0 / 31});
+                } else {
+                    same->second += 1.0 / 31;
+                }
+            }
+        }
+        hit[dead].push_back({dead, 1.0});
+    }
+
+    /**
+     * @brief Прочность, представляющая класс.
+     */
+    static int valueOf(int c) {
+        return c == dead ? 0 : c == 1 ? 20 : c == full ? 100 : c + 19;
+    }
+
+    /**
+     * @brief Класс прочности.
+     */
+    static int classOf(int value) {
+        return value <= 0 ? dead : value <= 20 ? 1 : value == 100 ? full : value - 19;
+    }
+
+    /**
+     * @brief Оценка памяти в байтах: нумерации векторов и окна четырех таблиц.
+     *
+     * Окно считается по уровням всех векторов, канонических в нем примерно в 2 и 2N раз меньше.
+     */
+    double memory() const {
+        std::vector<double> count(1, 1.0);
+        for (int t = 0; t < towers; ++t) {
+            std::vector<double> next(count.size() + full, 0.0);
+            for (size_t l = 0; l < count.size(); ++l) {
+                for (int c = 0; c < classes; ++c) {
+                    next[l + c] += count[l];
+                }
+            }
+            count.swap(next);
+        }
+        double window = 0;
+        for (size_t l = 0; l < count.size(); ++l) {
+            double sum = 0;
+            for (size_t d = 0; d <= (size_t)maxDrop && d <= l; ++d) {
+                sum += count[l - d];
+            }
+            window = std::max(window, sum);
+        }
+        double numberings = states * sizeof(int32_t) * (3 + 1 + 0.5 + 0.5 / towers);
+        double tables = window * width * sizeof(float) * (2 + 0.5 + 0.5 / towers);
+        return numberings + tables;
+    }
+
+    /**
+     * @brief Помещаются ли таблицы в memoryLimit.
+     */
+    bool fits() const {
+        return memory() <= memoryLimit;
+    }
+
+    int digit(long long state, int tower) const {
+        return (int)(state / radix[tower] % classes);
+    }
+
+    long long withDigit(long long state, int tower, int c) const {
+        return state + (c - digit(state, tower)) * radix[tower];
+    }
+
+    /**
+     * @brief Поворот кольца: башня center становится башней 0.
+     */
+    long long rotate(long long state, int center) const {
+        long long low = state % radix[center];
+        return state / radix[center] + low * radix[towers - center];
+    }
+
+    int levelOf(long long st) const {
+        int level = 0;
+        for (int t = 0; t < towers; ++t) {
+            level += digit(st, t);
+        }
+        return level;
+    }
+
+    /**
+     * @brief Первые count симметрий кольца: тождественная, отражение относительно башни 0,
+     * затем остальные повороты с отражениями. Башня t образа - башня map[t] исходного вектора.
+     */
+    std::vector<std::vector<int>> symmetries(int count) const {
+        std::vector<std::vector<int>> maps;
+        for (int r = 0; r < towers; ++r) {
+            for (int mirror = 0; mirror < 2; ++mirror) {
+                std::vector<int> map(towers);
+                for (int t = 0; t < towers; ++t) {
+                    map[t] = ((mirror ? towers - t : t) + r) % towers;
+                }
+                maps.push_back(map);
+            }
+        }
+        maps.resize(count);
+        return maps;
+    }
+
+    /**
+     * @brief Канонический образ вектора: наименьший среди образов при симметриях maps.
+     */
+    long long canonical(long long state, const std::vector<std::vector<int>>& maps) const {
+        int digits[BattleBatch::maxTowers];
+        for (int t = 0; t < towers; ++t) {
+            digits[t] = digit(state, t);
+        }
+        long long best = state;
+        for (const auto& map : maps) {
+            long long image = 0;
+            for (int t = 0; t < towers; ++t) {
+                image += digits[map[t]] * radix[t];
+            }
+            best = std::min(best, image);
+        }
+        return best;
+    }
+
+    /**
+     * @brief Нумерация канонических векторов по уровням.
+     * @param maps Симметрии, при которых значение таблицы не меняется
+     */
+    Numbering number(const std::vector<std::vector<int>>& maps) const {
+        const int levels = full * towers + 1;
+        Numbering n;
+        n.index.resize(states);
+        n.start.assign(levels + 1, 0);
+        for (long long st = 0; st < states; ++st) {
+            if (canonical(st, maps) == st) {
+                ++n.start[levelOf(st) + 1];
+            }
+        }
+        for (int l = 0; l < levels; ++l) {
+            n.start[l + 1] += n.start[l];
+        }
+        n.order.resize(n.start[levels]);
+        std::vector<int32_t> fill(n.start.begin(), n.start.end() - 1);
+        for (long long st = 0; st < states; ++st) {
+            long long image = canonical(st, maps);
+            if (image == st) {
+                n.index[st] = fill[levelOf(st)]++;
+                n.order[n.index[st]] = (int32_t)st;
+            } else {
+                n.index[st] = n.index[image];  // Образ меньше st и уже пронумерован
+            }
+        }
+        for (int l = 0; l < levels; ++l) {
+            n.window = std::max(n.window, n.start[l + 1] - n.start[std::max(0, l - maxDrop)]);
+        }
+        return n;
+    }
+
+    /**
+     * @brief acc += p * сдвиг src на shift выстрелов (значения после shift дополнительных выстрелов).
+     */
+    void accumulate(double* acc, const float* src, double p, int shift) const {
+        for (int k = 0; k + shift < width; ++k) {
+            acc[k] += p * src[k + shift];
+        }
+    }
+
+    /**
+     * @brief Расчет для начального состояния (все башни целые, цели нет).
+     */
+    Result solve() const {
+        Numbering plain = number(symmetries(1));
+        Numbering mirrored = number(symmetries(2));
+        Numbering canon = number(symmetries(2 * towers));
+        double win = pass(false, plain, mirrored, canon);
+        double rounds = pass(true, plain, mirrored, canon);
+        return Result{win, rounds, (long long)canon.order.size()};
+    }
+
+    /**
+     * @brief Один проход по уровням: вероятность победы или среднее число раундов.
+     * @param rounds Считать раунды (иначе победу)
+     * @param plain Нумерация всех векторов (afterRight, afterCenter)
+     * @param mirrored Векторы с точностью до отражения относительно башни 0 (target)
+     * @param canon Векторы с точностью до поворотов и отражений (choose)
+     * @return Значение в начальном состоянии при k = 0
+     */
+    double pass(bool rounds, const Numbering& plain, const Numbering& mirrored, const Numbering& canon) const {
+        const int levels = full * towers + 1;
+        // choose: значение без выбранной цели; target: цель - башня 0 (она цела)
+        std::vector<float> choose((size_t)canon.window * width), target((size_t)mirrored.window * width);
+        std::vector<float> afterRight((size_t)plain.window * width), afterCenter((size_t)plain.window * width);
+        std::vector<double> acc(width);
+
+        auto row = [&](std::vector<float>& table, const Numbering& n, long long st) {
+            return table.data() + (size_t)n.slot(st) * width;
+        };
+        auto following = [&](long long st) -> const float* {
+            return sticky && digit(st, 0) != dead ? row(target, mirrored, st) : row(choose, canon, st);
+        };
+        auto store = [&](std::vector<float>& table, const Numbering& n, long long st) {
+            float* out = row(table, n, st);
+            for (int k = 0; k < width; ++k) {
+                out[k] = (float)acc[k];
+            }
+        };
+
+        for (int level = 0; level < levels; ++level) {
+            // Башни N-1 и 0 уже получили удар, ожидание по броску в центр
+            for (int32_t i = plain.start[level]; i < plain.start[level + 1]; ++i) {
+                long long st = plain.order[i];
+                if (digit(st, 0) == dead) {
+                    continue;
+                }
+                std::fill(acc.begin(), acc.end(), 0.0);
+                for (const auto& [c, p] : hit[digit(st, 0)]) {
+                    accumulate(acc.data(), row(afterRight, plain, withDigit(st, 0, c)), p, c != dead);
+                }
+                store(afterCenter, plain, st);
+            }
+            // Раунд с центром 0: ожидание по броску в башню N-1
+            for (int32_t i = mirrored.start[level]; i < mirrored.start[level + 1]; ++i) {
+                long long st = mirrored.order[i];
+                if (digit(st, 0) == dead) {
+                    continue;
+                }
+                std::fill(acc.begin(), acc.end(), 0.0);
+                for (const auto& [c, p] : hit[digit(st, towers - 1)]) {
+                    accumulate(acc.data(), row(afterCenter, plain, withDigit(st, towers - 1, c)), p, c != dead);
+                }
+                if (rounds) {
+                    for (int k = 0; k < width; ++k) {
+                        acc[k] += alive[k];  // Этот раунд состоится, если дракон жив
+                    }
+                }
+                store(target, mirrored, st);
+            }
+            // Без цели: центр равновероятно среди целых башен
+            for (int32_t i = canon.start[level]; i < canon.start[level + 1]; ++i) {
+                long long st = canon.order[i];
+                std::fill(acc.begin(), acc.end(), 0.0);
+                int standing = 0;
+                for (int t = 0; t < towers; ++t) {
+                    if (digit(st, t) != dead) {
+                        ++standing;
+                        accumulate(acc.data(), row(target, mirrored, rotate(st, t)), 1.0, 0);
+                    }
+                }
+                if (standing == 0) {
+                    if (!rounds) {
+                        acc = alive;  // Башни пали: дракон победил, если жив
+                    }
+                } else {
+                    for (double& v : acc) {
+                        v /= standing;
+                    }
+                }
+                store(choose, canon, st);
+            }
+            // Ожидание по броску в башню 1, башни N-1 и 0 уже получили удар
+            for (int32_t i = plain.start[level]; i < plain.start[level + 1]; ++i) {
+                long long st = plain.order[i];
+                std::fill(acc.begin(), acc.end(), 0.0);
+                for (const auto& [c, p] : hit[digit(st, 1)]) {
+                    accumulate(acc.data(), following(withDigit(st, 1, c)), p, c != dead);
+                }
+                store(afterRight, plain, st);
+            }
+        }
+
+        return row(choose, canon, states - 1)[0];
+    }
+};
+
+/**
+ * @brief Сверка точного решения с пакетным Монте-Карло для небольших замков.
+ */
+void validateExact(int health, long long battles, uint32_t seed) {
+    using Clock = std::chrono::steady_clock;
+    for (int towers = 3; towers <= BattleBatch::maxTowers; ++towers) {
+        for (int strategy = 1; strategy <= 2; ++strategy) {
+            ExactSolver solver(towers, health, strategy);
+            if (!solver.fits()) {
+                std::cout << towers << " towers: " << solver.states << " tower states, too many for the exact solver"
+                          << std::endl;
+                return;
+            }
+            auto t0 = Clock::now();
+            ExactSolver::Result exact = solver.solve();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+            WinRate mc{0, 0, 0};
+            for (long long done = 0; done < battles; done += BattleBatch::defaultLanes) {
+                int lanes = (int)std::min<long long>(BattleBatch::defaultLanes, battles - done);
+                BattleBatch batch(lanes, towers, health, strategy, seed, (uint32_t)done);
+                batch.run();
+                mc.battles += lanes;
+                mc.wins += batch.dragonWins();
+                mc.rounds += batch.totalRounds();
+            }
+            double p = mc.rate();
+            double half = 1.96 * std::sqrt(p * (1 - p) / mc.battles);
+            std::cout << towers << " towers, strategy " << strategy << ": exact " << exact.winProbability * 100
+                      << "% wins, " << exact.expectedRounds << " rounds (" << exact.states << " states, " << ms
+                      << " ms); Monte Carlo " << p * 100 << " +- " << half * 100 << "%, "
+                      << double(mc.rounds) / mc.battles << " rounds" << std::endl;
+        }
+    }
+}
+
+/**
+ * @brief Бой по первой стратегии в исходном виде: полный подсчет целых башен на каждом
+ * шаге и повторный выбор центра до попадания в целую башню. Нужен для сравнения.
+ * @return Количество раундов.
+ */
+int simulateLegacyStrategyFirst(Castle &castle, Dragon &dragon) {
+    int round = 0;
+    while (dragon.isAlive() && castle.countAliveTowers() > 0) {
+        int towers_numbers[3];
+        towers_numbers[1] = dragon.mainTower(castle.numTowers);
+        if (castle.towers[towers_numbers[1]].isAlive()) {
+            ++round;
+            towers_numbers[0] = (towers_numbers[1] == 0) ? castle.numTowers - 1 : towers_numbers[1] - 1;
+            towers_numbers[2] = (towers_numbers[1] == castle.numTowers - 1) ? 0 : towers_numbers[1] + 1;
+            int dragonAttack[3];
+            dragon.attackTowers(dragonAttack);
+            castle.getCastleDamage(dragonAttack, towers_numbers);
+            dragon.getTowerDamage(castle.castleAttack(towers_numbers));
+        }
+    }
+    return round;
+}
+
+/**
+ * @brief Замер боя с большим замком: исходный цикл против учета целых башен за O(1).
+ *
+ * Дракон практически бессмертен, чтобы бой шел до последней башни, где повторный
+ * выбор центра и полный подсчет башен обходятся дороже всего.
+ * @param maxTowers Наибольшее количество башен.
+ * @param legacyLimit Наибольший замок, на котором запускается исходный цикл.
+ */
+void benchmarkLargeCastle(int maxTowers, int legacyLimit) {
+    using Clock = std::chrono::steady_clock;
+    for (int n = 1000; n <= maxTowers; n *= 10) {
+        srand(n);
+        Castle castle(n);
+        Dragon dragon;
+        dragon.health = 1 << 30;
+        int round = 0;
+        auto t0 = Clock::now();
+        simulateBattleStrategyFirst(castle, dragon, round, false);
+        double fast = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::cout << n << " towers: " << round << " rounds, O(1) alive bookkeeping " << fast << " ms";
+
+        if (n <= legacyLimit) {
+            srand(n);
+            Castle legacyCastle(n);
+            Dragon legacyDragon;
+            legacyDragon.health = 1 << 30;
+            auto t1 = Clock::now();
+            int legacyRounds = simulateLegacyStrategyFirst(legacyCastle, legacyDragon);
+            double slow = std::chrono::duration<double, std::milli>(Clock::now() - t1).count();
+            std::cout << ", rescan + rejection " << slow << " ms (" << legacyRounds << " rounds, "
+                      << slow / fast << "x)";
+        }
+        std::cout << std::endl;
+    }
+}
+
+/**
+ * @brief Запись журнала нескольких боев в файл и замер стоимости записи.
+ *
+ * Разница времени боев с журналом и без него меньше шума замера, поэтому цена события
+ * меряется отдельно: вызовами record подряд, сначала до заполнения буфера, затем с
+ * многократной перезаписью по кругу.
+ * @param path Файл журнала
+ * @param battles Количество боев для замера
+ */
+void recordBattleLog(const std::string& path, int battles) {
+    using Clock = std::chrono::steady_clock;
+    if (!BattleLog::enabled) {
+        std::cout << "Battle log is compiled out (BATTLE_LOG=0)" << std::endl;
+        return;
+    }
+    BattleLog log;
+    for (int strategy = 1; strategy <= 2; ++strategy) {
+        Castle castle;
+        Dragon dragon;
+        int round = 0;
+        if (strategy == 1) {
+            simulateBattleStrategyFirst(castle, dragon, round, false, &log);
+        } else {
+            simulateBattleStrategySecond(castle, dragon, round, false, &log);
+        }
+        ++log.battle;
+    }
+    if (!log.save(path)) {
+        std::cerr << path << ": cannot write" << std::endl;
+        return;
+    }
+    std::cout << "Saved " << log.recorded << " events to " << path << std::endl;
+
+    // Одни и те же бои с журналом и без него
+    auto run = [battles](BattleLog* target) {
+        srand(1);
+        auto start = Clock::now();
+        for (int i = 0; i < battles; ++i) {
+            Castle castle;
+            Dragon dragon;
+            int round = 0;
+            simulateBattleStrategyFirst(castle, dragon, round, false, target);
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+    double plain = run(nullptr);
+    BattleLog timing;
+    double logged = run(&timing);
+    std::cout << battles << " battles: " << plain / 1e6 << " ms without log, " << logged / 1e6 << " ms with log ("
+              << timing.recorded << " events)" << std::endl;
+
+    // Только запись: сначала заполнение буфера, затем перезапись по кругу
+    Castle castle(3);
+    const int targets[3] = {2, 0, 1}, heads[3] = {20, 35, 50}, shots[3] = {25, 0, 40};
+    BattleLog ring;
+    const uint64_t size = ring.events.size();
+    const uint64_t laps = 64;
+    auto record = [&](uint64_t count) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < count; ++i) {
+            ring.record(1 + (int)(i & 1), (int)i, targets, heads, shots, castle, (int)(i % 625));
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+    };
+    double filling = record(size);
+    double wrapping = record(size * (laps - 1));
+    std::cout << "record(): " << filling << " ns per event filling " << size << " slots, " << wrapping
+              << " ns per event over the next " << size * (laps - 1) << " (ring wrapped " << laps - 1 << " times)"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "montecarlo") {
+        // Доли побед по стратегиям: montecarlo [боев] [зерно]
+        long long battles = argc > 2 ? std::stoll(argv[2]) : 1000000;
+        uint32_t seed = argc > 3 ? (uint32_t)std::stoul(argv[3]) : (uint32_t)time(0);
+        compareEngines(battles, seed);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "balance") {
+        // Здоровье дракона для 50% побед: balance [потоков] [зерно]
+        int threads = argc > 2 ? std::stoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+        uint32_t seed = argc > 3 ? (uint32_t)std::stoul(argv[3]) : (uint32_t)time(0);
+        Balancer(threads, seed).printTable(3, BattleBatch::maxTowers);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "exact") {
+        // Точное решение и сверка с Монте-Карло: exact [здоровье дракона] [боев] [зерно]
+        int health = argc > 2 ? std::stoi(argv[2]) : 625;
+        if (health < 1) {
+            std::cerr << "Dragon health must be positive: " << health << std::endl;
+            return 1;
+        }
+        long long battles = argc > 3 ? std::stoll(argv[3]) : 1000000;
+        uint32_t seed = argc > 4 ? (uint32_t)std::stoul(argv[4]) : (uint32_t)time(0);
+        validateExact(health, battles, seed);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "log") {
+        // Бинарный журнал: log [файл] [боев для замера]
+        srand(time(0));
+        recordBattleLog(argc > 2 ? argv[2] : "battle.log", argc > 3 ? std::stoi(argv[3]) : 200000);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "decode") {
+        // Текст журнала: decode [файл]
+        return BattleLog::decode(argc > 2 ? argv[2] : "battle.log", std::cout) ? 0 : 1;
+    }
+    if (argc > 1 && std::string(argv[1]) == "variants") {
+        // Драконы с 1..8 головами и радиусом атаки 0..3: variants [башен] [здоровье] [боев]
+        srand(time(0));
+        int numTowers = argc > 2 ? std::stoi(argv[2]) : 8;
+        int health = argc > 3 ? std::stoi(argv[3]) : 625;
+        long long battles = argc > 4 ? std::stoll(argv[4]) : 20000;
+        printVariants(numTowers, health, battles);
+        return 0;
+    }
+    if (argc > 1 && std::string(argv[1]) == "towers") {
+        // Большие замки: towers [макс. башен] [макс. башен для исходного цикла]
+        int maxTowers = argc > 2 ? std::stoi(argv[2]) : 100000;
+        int legacyLimit = argc > 3 ? std::stoi(argv[3]) : 10000;
+        benchmarkLargeCastle(maxTowers, legacyLimit);
+        return 0;
+    }
+
     srand(time(0));
 
     Castle castle;